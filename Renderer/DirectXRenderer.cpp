@@ -1,6 +1,7 @@
 #include "DirectXRenderer.h"
 #include <d3dcompiler.h>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <sstream>
 
@@ -8,6 +9,8 @@ DirectXRenderer::DirectXRenderer()
     : m_hwnd(nullptr), m_device(nullptr), m_context(nullptr), 
       m_swapChain(nullptr), m_renderTargetView(nullptr)
     , m_transformX(0.0f), m_transformY(0.0f), m_rotation(0.0f), m_scale(1.0f)
+    , m_batchVertexBuffer(nullptr), m_batchIndexBuffer(nullptr)
+    , m_batchVertexCapacity(0), m_batchIndexCapacity(0)
 {
     m_clearColor[0] = 0.0f;
     m_clearColor[1] = 0.0f;
@@ -100,6 +103,14 @@ bool DirectXRenderer::Initialize(HWND hwnd)
 
 void DirectXRenderer::Cleanup()
 {
+    m_batcher.Clear();
+    if (m_batchVertexBuffer) m_batchVertexBuffer->Release();
+    if (m_batchIndexBuffer) m_batchIndexBuffer->Release();
+    m_batchVertexBuffer = nullptr;
+    m_batchIndexBuffer = nullptr;
+    m_batchVertexCapacity = 0;
+    m_batchIndexCapacity = 0;
+    
     if (m_renderTargetView) m_renderTargetView->Release();
     if (m_swapChain) m_swapChain->Release();
     if (m_context) m_context->Release();
@@ -118,6 +129,7 @@ void DirectXRenderer::BeginFrame()
 
 void DirectXRenderer::EndFrame()
 {
+    FlushBatch();
     m_swapChain->Present(0, 0);
 }
 
@@ -131,166 +143,106 @@ void DirectXRenderer::SetClearColor(float r, float g, float b, float a)
 
 void DirectXRenderer::DrawQuad(float x, float y, float width, float height)
 {
-    // Define vertices for a quad (position only for simplicity)
-    struct Vertex {
-        float x, y, z;
-    };
-    
-    Vertex vertices[] = {
-        { x, y, 0.0f },           // Top-left
-        { x + width, y, 0.0f },   // Top-right
-        { x, y + height, 0.0f },  // Bottom-left
-        { x + width, y + height, 0.0f }  // Bottom-right
-    };
-    
-    // Define indices to form two triangles from the quad
-    WORD indices[] = {
-        0, 1, 2,  // First triangle
-        1, 3, 2   // Second triangle
-    };
-    
-    // Create vertex buffer
-    D3D11_BUFFER_DESC vertexBufferDesc = {};
-    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDesc.ByteWidth = sizeof(Vertex) * 4;
-    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    
-    D3D11_SUBRESOURCE_DATA vertexData = {};
-    vertexData.pSysMem = vertices;
-    
-    ID3D11Buffer* vertexBuffer = nullptr;
-    HRESULT hr = m_device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
-    if (FAILED(hr)) {
-        return;
-    }
-    
-    // Create index buffer
-    D3D11_BUFFER_DESC indexBufferDesc = {};
-    indexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    indexBufferDesc.ByteWidth = sizeof(WORD) * 6;
-    indexBufferDesc.BindFlags = D3D11_BIND_INDEX_BUFFER;
-    indexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    
-    D3D11_SUBRESOURCE_DATA indexData = {};
-    indexData.pSysMem = indices;
-    
-    ID3D11Buffer* indexBuffer = nullptr;
-    hr = m_device->CreateBuffer(&indexBufferDesc, &indexData, &indexBuffer);
-    if (FAILED(hr)) {
-        vertexBuffer->Release();
-        return;
-    }
-    
-    // Set vertex and index buffers
-    UINT stride = sizeof(Vertex);
-    UINT offset = 0;
-    m_context->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
-    m_context->IASetIndexBuffer(indexBuffer, DXGI_FORMAT_R16_UINT, 0);
-    
-    // Set primitive topology
-    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-    
-    // Draw indexed
-    m_context->DrawIndexed(6, 0, 0);
-    
-    // Clean up temporary buffers
-    vertexBuffer->Release();
-    indexBuffer->Release();
+    m_batcher.AddQuad(x, y, width, height);
 }
 
 void DirectXRenderer::DrawTriangle(float x1, float y1, float x2, float y2, float x3, float y3)
 {
-    // Define vertices for a triangle
-    struct Vertex {
-        float x, y, z;
-    };
-    
-    Vertex vertices[] = {
-        { x1, y1, 0.0f },  // Vertex 1
-        { x2, y2, 0.0f },  // Vertex 2
-        { x3, y3, 0.0f }   // Vertex 3
-    };
+    m_batcher.AddTriangle(x1, y1, x2, y2, x3, y3);
+}
+
+void DirectXRenderer::DrawCircle(float centerX, float centerY, float radius, int segments)
+{
+    m_batcher.AddCircle(centerX, centerY, radius, segments);
+}
+
+void DirectXRenderer::FlushBatch()
+{
+    if (m_batcher.IsEmpty() || !m_context) {
+        m_batcher.Clear();
+        return;
+    }
     
-    // Create vertex buffer
-    D3D11_BUFFER_DESC vertexBufferDesc = {};
-    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDesc.ByteWidth = sizeof(Vertex) * 3;
-    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+    m_batcher.Build();
+    const std::vector<BatchVertex>& vertices = m_batcher.GetVertices();
+    const std::vector<uint32_t>& indices = m_batcher.GetIndices();
+    
+    // One dynamic vertex buffer and one index buffer for the whole frame, grown when too small
+    UINT vertexCount = static_cast<UINT>(vertices.size());
+    UINT indexCount = static_cast<UINT>(indices.size());
+    if (!EnsureBatchBuffer(m_batchVertexBuffer, m_batchVertexCapacity, vertexCount, sizeof(BatchVertex),
+                           D3D11_BIND_VERTEX_BUFFER) ||
+        !EnsureBatchBuffer(m_batchIndexBuffer, m_batchIndexCapacity, indexCount, sizeof(uint32_t),
+                           D3D11_BIND_INDEX_BUFFER)) {
+        m_batcher.Clear();
+        return;
+    }
     
-    D3D11_SUBRESOURCE_DATA vertexData = {};
-    vertexData.pSysMem = vertices;
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    if (FAILED(m_context->Map(m_batchVertexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        m_batcher.Clear();
+        return;
+    }
+    memcpy(mapped.pData, vertices.data(), vertexCount * sizeof(BatchVertex));
+    m_context->Unmap(m_batchVertexBuffer, 0);
     
-    ID3D11Buffer* vertexBuffer = nullptr;
-    HRESULT hr = m_device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
-    if (FAILED(hr)) {
+    if (FAILED(m_context->Map(m_batchIndexBuffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+        m_batcher.Clear();
         return;
     }
+    memcpy(mapped.pData, indices.data(), indexCount * sizeof(uint32_t));
+    m_context->Unmap(m_batchIndexBuffer, 0);
     
-    // Set vertex buffer
-    UINT stride = sizeof(Vertex);
+    UINT stride = sizeof(BatchVertex);
     UINT offset = 0;
-    m_context->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
-    
-    // Set primitive topology
+    m_context->IASetVertexBuffers(0, 1, &m_batchVertexBuffer, &stride, &offset);
+    m_context->IASetIndexBuffer(m_batchIndexBuffer, DXGI_FORMAT_R32_UINT, 0);
     m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
     
-    // Draw
-    m_context->Draw(3, 0);
+    // Ranges are already merged by state, so bindings only change between ranges
+    bool first = true;
+    BatchStateKey bound = {};
+    for (const BatchDrawRange& range : m_batcher.GetDrawRanges()) {
+        if (first || range.key.shaderId != bound.shaderId) {
+            BindShader(range.key.shaderId);
+        }
+        if (first || range.key.textureId != bound.textureId) {
+            BindTexture(range.key.textureId);
+        }
+        bound = range.key;
+        first = false;
+        m_context->DrawIndexed(range.indexCount, range.firstIndex, 0);
+    }
     
-    // Clean up temporary buffer
-    vertexBuffer->Release();
+    m_batcher.Clear();
 }
 
-void DirectXRenderer::DrawCircle(float centerX, float centerY, float radius, int segments)
+bool DirectXRenderer::EnsureBatchBuffer(ID3D11Buffer*& buffer, UINT& capacity, UINT required, UINT stride, UINT bindFlags)
 {
-    // Define vertices for a circle using triangle fan approach
-    struct Vertex {
-        float x, y, z;
-    };
-    
-    // Create vertices for the circle
-    std::vector<Vertex> vertices;
-    vertices.push_back({centerX, centerY, 0.0f}); // Center vertex
-    
-    // Create vertices around the circle
-    for (int i = 0; i <= segments; i++) {
-        float angle = 2.0f * 3.14159265359f * i / segments;
-        float x = centerX + radius * cosf(angle);
-        float y = centerY + radius * sinf(angle);
-        vertices.push_back({x, y, 0.0f});
+    if (buffer && capacity >= required) {
+        return true;
     }
     
-    // Create vertex buffer
-    D3D11_BUFFER_DESC vertexBufferDesc = {};
-    vertexBufferDesc.Usage = D3D11_USAGE_DYNAMIC;
-    vertexBufferDesc.ByteWidth = sizeof(Vertex) * static_cast<UINT>(vertices.size());
-    vertexBufferDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-    vertexBufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
-    
-    D3D11_SUBRESOURCE_DATA vertexData = {};
-    vertexData.pSysMem = vertices.data();
-    
-    ID3D11Buffer* vertexBuffer = nullptr;
-    HRESULT hr = m_device->CreateBuffer(&vertexBufferDesc, &vertexData, &vertexBuffer);
-    if (FAILED(hr)) {
-        return;
+    UINT newCapacity = capacity > 0 ? capacity : 1024;
+    while (newCapacity < required) {
+        newCapacity *= 2;
     }
     
-    // Set vertex buffer
-    UINT stride = sizeof(Vertex);
-    UINT offset = 0;
-    m_context->IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
-    
-    // Set primitive topology to triangle fan
-    m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP);
+    D3D11_BUFFER_DESC bufferDesc = {};
+    bufferDesc.Usage = D3D11_USAGE_DYNAMIC;
+    bufferDesc.ByteWidth = stride * newCapacity;
+    bufferDesc.BindFlags = bindFlags;
+    bufferDesc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     
-    // Draw with triangle fan (we need to draw vertices.size()-1 points)
-    m_context->Draw(static_cast<UINT>(vertices.size()) - 1, 1); // Start from index 1 to skip center
+    ID3D11Buffer* newBuffer = nullptr;
+    if (FAILED(m_device->CreateBuffer(&bufferDesc, nullptr, &newBuffer))) {
+        return false;
+    }
     
-    // Clean up temporary buffer
-    vertexBuffer->Release();
+    if (buffer) buffer->Release();
+    buffer = newBuffer;
+    capacity = newCapacity;
+    return true;
 }
 
 void DirectXRenderer::SetTransform(float x, float y, float rotation, float scale)
@@ -299,6 +251,7 @@ void DirectXRenderer::SetTransform(float x, float y, float rotation, float scale
     m_transformY = y;
     m_rotation = rotation;
     m_scale = scale;
+    m_batcher.SetTransform(x, y, rotation, scale);
 }
 
 unsigned int DirectXRenderer::LoadTexture(const std::string& filename)
@@ -475,7 +428,12 @@ unsigned int DirectXRenderer::LoadTextureFromFile(const std::string& filename, u
 
 void DirectXRenderer::UseTexture(unsigned int textureId)
 {
-    // In a real implementation, this would bind the texture resource
+    // Bound when the batch is drawn; primitives added from now on carry this texture
+    m_batcher.SetTexture(textureId);
+}
+
+void DirectXRenderer::BindTexture(unsigned int textureId)
+{
     auto it = textures.find(textureId);
     if (it != textures.end() && it->second.resourceView != nullptr) {
         // Set the shader resource view for the texture
@@ -560,10 +518,12 @@ unsigned int DirectXRenderer::LoadShader(const std::string& vertexShaderFile, co
     // Define input layout
     D3D11_INPUT_ELEMENT_DESC inputLayoutDesc[] = {
         { "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
+        { "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, 20, D3D11_INPUT_PER_VERTEX_DATA, 0 },
     };
     
     ID3D11InputLayout* inputLayout = nullptr;
-    hr = m_device->CreateInputLayout(inputLayoutDesc, 1, 
+    hr = m_device->CreateInputLayout(inputLayoutDesc, 3, 
                                      compiledVS->GetBufferPointer(), compiledVS->GetBufferSize(), 
                                      &inputLayout);
     if (FAILED(hr)) {
@@ -645,7 +605,12 @@ std::string DirectXRenderer::LoadShaderFromFile(const std::string& filename, boo
 
 void DirectXRenderer::UseShader(unsigned int shaderId)
 {
-    // In a real implementation, this would activate the shader program
+    // Bound when the batch is drawn; primitives added from now on use this shader
+    m_batcher.SetShader(shaderId);
+}
+
+void DirectXRenderer::BindShader(unsigned int shaderId)
+{
     auto it = shaders.find(shaderId);
     if (it != shaders.end() && it->second.vertexShader != nullptr && it->second.pixelShader != nullptr) {
         // Set the vertex shader
@@ -666,6 +631,9 @@ void DirectXRenderer::SetSurface(unsigned int width, unsigned int height)
 {
     if (!m_swapChain) return;
     
+    // Geometry queued for the old back buffer is drawn before it is released
+    FlushBatch();
+    
     // Release current render target view
     if (m_renderTargetView) {
         m_renderTargetView->Release();
@@ -1,5 +1,6 @@
 #pragma once
 #include "IRenderer.h"
+#include "GeometryBatcher.h"
 #include <windows.h>
 #include <d3d11.h>
 #include <dxgi.h>
@@ -80,12 +81,25 @@ private:
     float m_rotation;
     float m_scale;
     
+    // 几何批处理：绘制调用先写入批处理器，在EndFrame时一次上传并按状态分段绘制
+    GeometryBatcher m_batcher;
+    ID3D11Buffer* m_batchVertexBuffer;
+    ID3D11Buffer* m_batchIndexBuffer;
+    UINT m_batchVertexCapacity;
+    UINT m_batchIndexCapacity;
+    
     // Texture management
     std::unordered_map<unsigned int, TextureData> textures;
     
     // Shader management
     std::unordered_map<unsigned int, ShaderData> shaders;
     
+    // Helper methods for batching
+    void FlushBatch();
+    bool EnsureBatchBuffer(ID3D11Buffer*& buffer, UINT& capacity, UINT required, UINT stride, UINT bindFlags);
+    void BindTexture(unsigned int textureId);
+    void BindShader(unsigned int shaderId);
+    
     // Helper methods for texture loading
     unsigned int CreatePlaceholderTexture(unsigned int textureId, const std::string& filename);
     unsigned int LoadTextureFromFile(const std::string& filename, unsigned int textureId);
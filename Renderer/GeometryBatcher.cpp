@@ -0,0 +1,247 @@
+#include "GeometryBatcher.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+    const float kPi = 3.14159265359f;
+}
+
+GeometryBatcher::GeometryBatcher()
+    : order(BatchOrder::Submission), m00(1.0f), m01(0.0f), m10(0.0f), m11(1.0f),
+      translateX(0.0f), translateY(0.0f), built(false)
+{
+    currentKey.layer = 0;
+    currentKey.shaderId = 0;
+    currentKey.textureId = 0;
+    color[0] = 1.0f;
+    color[1] = 1.0f;
+    color[2] = 1.0f;
+    color[3] = 1.0f;
+}
+
+void GeometryBatcher::SetTransform(float x, float y, float rotation, float scale)
+{
+    float angle = rotation * kPi / 180.0f;
+    float cosAngle = cosf(angle) * scale;
+    float sinAngle = sinf(angle) * scale;
+    m00 = cosAngle;
+    m01 = -sinAngle;
+    m10 = sinAngle;
+    m11 = cosAngle;
+    translateX = x;
+    translateY = y;
+}
+
+void GeometryBatcher::SetColor(float r, float g, float b, float a)
+{
+    color[0] = r;
+    color[1] = g;
+    color[2] = b;
+    color[3] = a;
+}
+
+void GeometryBatcher::AddQuad(float x, float y, float width, float height)
+{
+    uint32_t base = static_cast<uint32_t>(vertices.size());
+    BatchVertex* quad = AppendVertices(4);
+    WriteVertex(quad[0], x, y, 0.0f, 0.0f);
+    WriteVertex(quad[1], x + width, y, 1.0f, 0.0f);
+    WriteVertex(quad[2], x, y + height, 0.0f, 1.0f);
+    WriteVertex(quad[3], x + width, y + height, 1.0f, 1.0f);
+
+    uint32_t* index = AppendIndices(6);
+    index[0] = base;
+    index[1] = base + 1;
+    index[2] = base + 2;
+    index[3] = base + 1;
+    index[4] = base + 3;
+    index[5] = base + 2;
+}
+
+void GeometryBatcher::AddTriangle(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    uint32_t base = static_cast<uint32_t>(vertices.size());
+    BatchVertex* triangle = AppendVertices(3);
+    WriteVertex(triangle[0], x1, y1, 0.0f, 0.0f);
+    WriteVertex(triangle[1], x2, y2, 1.0f, 0.0f);
+    WriteVertex(triangle[2], x3, y3, 0.0f, 1.0f);
+
+    uint32_t* index = AppendIndices(3);
+    index[0] = base;
+    index[1] = base + 1;
+    index[2] = base + 2;
+}
+
+void GeometryBatcher::AddCircle(float centerX, float centerY, float radius, int segments)
+{
+    segments = std::max(segments, 3);
+    const std::vector<float>& unit = GetUnitCircle(segments);
+
+    // A fan written as a triangle list, so circles merge with everything else in one draw
+    uint32_t base = static_cast<uint32_t>(vertices.size());
+    uint32_t rimCount = static_cast<uint32_t>(segments);
+    BatchVertex* circle = AppendVertices(rimCount + 1);
+    WriteVertex(circle[0], centerX, centerY, 0.5f, 0.5f);
+    for (uint32_t i = 0; i < rimCount; i++) {
+        float cosValue = unit[i * 2];
+        float sinValue = unit[i * 2 + 1];
+        WriteVertex(circle[i + 1], centerX + cosValue * radius, centerY + sinValue * radius,
+                    0.5f + 0.5f * cosValue, 0.5f + 0.5f * sinValue);
+    }
+
+    uint32_t* index = AppendIndices(rimCount * 3);
+    for (uint32_t i = 0; i < rimCount; i++) {
+        index[i * 3] = base;
+        index[i * 3 + 1] = base + 1 + i;
+        index[i * 3 + 2] = base + 1 + (i + 1) % rimCount;
+    }
+}
+
+void GeometryBatcher::Build()
+{
+    if (built) {
+        return;
+    }
+    built = true;
+
+    if (order == BatchOrder::StateSorted) {
+        SortPrimitives(true);
+    } else {
+        // Submission order only has to move primitives when a lower layer was added after a higher one
+        for (size_t i = 1; i < primitives.size(); i++) {
+            if (primitives[i].key.layer < primitives[i - 1].key.layer) {
+                SortPrimitives(false);
+                break;
+            }
+        }
+    }
+    BuildRanges();
+}
+
+void GeometryBatcher::Clear()
+{
+    primitives.clear();
+    vertices.clear();
+    indices.clear();
+    drawRanges.clear();
+    built = false;
+}
+
+GeometryBatcherStats GeometryBatcher::GetStats() const
+{
+    GeometryBatcherStats stats;
+    stats.primitiveCount = static_cast<uint32_t>(primitives.size());
+    stats.vertexCount = static_cast<uint32_t>(vertices.size());
+    stats.indexCount = static_cast<uint32_t>(indices.size());
+    stats.drawCount = static_cast<uint32_t>(drawRanges.size());
+    return stats;
+}
+
+BatchVertex* GeometryBatcher::AppendVertices(uint32_t count)
+{
+    // Every Add opens a primitive; the matching AppendIndices call closes it
+    Primitive primitive;
+    primitive.key = currentKey;
+    primitive.firstVertex = static_cast<uint32_t>(vertices.size());
+    primitive.vertexCount = count;
+    primitive.firstIndex = static_cast<uint32_t>(indices.size());
+    primitive.indexCount = 0;
+    primitives.push_back(primitive);
+
+    vertices.resize(vertices.size() + count);
+    return &vertices[primitive.firstVertex];
+}
+
+uint32_t* GeometryBatcher::AppendIndices(uint32_t count)
+{
+    primitives.back().indexCount = count;
+    size_t first = indices.size();
+    indices.resize(first + count);
+    return &indices[first];
+}
+
+void GeometryBatcher::WriteVertex(BatchVertex& vertex, float x, float y, float u, float v) const
+{
+    vertex.x = translateX + m00 * x + m01 * y;
+    vertex.y = translateY + m10 * x + m11 * y;
+    vertex.z = 0.0f;
+    vertex.u = u;
+    vertex.v = v;
+    vertex.color[0] = color[0];
+    vertex.color[1] = color[1];
+    vertex.color[2] = color[2];
+    vertex.color[3] = color[3];
+}
+
+void GeometryBatcher::SortPrimitives(bool byState)
+{
+    // Stable, so primitives sharing a key keep their submission order
+    sortOrder.resize(primitives.size());
+    for (uint32_t i = 0; i < sortOrder.size(); i++) {
+        sortOrder[i] = i;
+    }
+    std::stable_sort(sortOrder.begin(), sortOrder.end(), [this, byState](uint32_t a, uint32_t b) {
+        return byState ? primitives[a].key < primitives[b].key : primitives[a].key.layer < primitives[b].key.layer;
+    });
+
+    sortedVertices.resize(vertices.size());
+    sortedIndices.resize(indices.size());
+    uint32_t vertexHead = 0;
+    uint32_t indexHead = 0;
+    sortedPrimitives.clear();
+    for (uint32_t primitiveIndex : sortOrder) {
+        const Primitive& source = primitives[primitiveIndex];
+        std::copy(vertices.begin() + source.firstVertex, vertices.begin() + source.firstVertex + source.vertexCount,
+                  sortedVertices.begin() + vertexHead);
+
+        // Rebase the indices onto the primitive's new vertex position
+        for (uint32_t i = 0; i < source.indexCount; i++) {
+            sortedIndices[indexHead + i] = indices[source.firstIndex + i] - source.firstVertex + vertexHead;
+        }
+
+        Primitive moved = source;
+        moved.firstVertex = vertexHead;
+        moved.firstIndex = indexHead;
+        sortedPrimitives.push_back(moved);
+        vertexHead += source.vertexCount;
+        indexHead += source.indexCount;
+    }
+
+    vertices.swap(sortedVertices);
+    indices.swap(sortedIndices);
+    primitives.swap(sortedPrimitives);
+}
+
+void GeometryBatcher::BuildRanges()
+{
+    drawRanges.clear();
+    for (const Primitive& primitive : primitives) {
+        if (primitive.indexCount == 0) {
+            continue;
+        }
+        // Primitives are contiguous in the index stream, so equal neighbours extend the last range
+        if (!drawRanges.empty() && drawRanges.back().key == primitive.key) {
+            drawRanges.back().indexCount += primitive.indexCount;
+        } else {
+            drawRanges.push_back({primitive.key, primitive.firstIndex, primitive.indexCount});
+        }
+    }
+}
+
+const std::vector<float>& GeometryBatcher::GetUnitCircle(int segments)
+{
+    auto it = unitCircles.find(segments);
+    if (it != unitCircles.end()) {
+        return it->second;
+    }
+
+    std::vector<float>& unit = unitCircles[segments];
+    unit.resize(segments * 2);
+    for (int i = 0; i < segments; i++) {
+        float angle = 2.0f * kPi * i / segments;
+        unit[i * 2] = cosf(angle);
+        unit[i * 2 + 1] = sinf(angle);
+    }
+    return unit;
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Vertex written by the batcher. Position is float3 so it matches the POSITION layout
+// the DirectX shaders already declare, followed by TEXCOORD0 and COLOR0.
+struct BatchVertex
+{
+    float x, y, z;
+    float u, v;
+    float color[4];
+};
+
+// Pipeline state a primitive needs; primitives with equal keys can share one draw
+struct BatchStateKey
+{
+    uint32_t layer;
+    unsigned int shaderId;
+    unsigned int textureId;
+
+    bool operator==(const BatchStateKey& other) const
+    {
+        return layer == other.layer && shaderId == other.shaderId && textureId == other.textureId;
+    }
+    bool operator!=(const BatchStateKey& other) const { return !(*this == other); }
+    bool operator<(const BatchStateKey& other) const
+    {
+        if (layer != other.layer) return layer < other.layer;
+        if (shaderId != other.shaderId) return shaderId < other.shaderId;
+        return textureId < other.textureId;
+    }
+};
+
+// One draw call over the built index stream; indices are absolute into the vertex stream
+struct BatchDrawRange
+{
+    BatchStateKey key;
+    uint32_t firstIndex;
+    uint32_t indexCount;
+};
+
+enum class BatchOrder
+{
+    Submission,   // inside a layer, draw in submission order, merging neighbours that share a key
+    StateSorted   // inside a layer, group primitives by shader then texture
+};
+
+struct GeometryBatcherStats
+{
+    uint32_t primitiveCount;
+    uint32_t vertexCount;
+    uint32_t indexCount;
+    uint32_t drawCount;
+};
+
+// Backend-neutral CPU batcher. Draw calls become one indexed triangle list plus a list of
+// draw ranges, so a backend only uploads two streams and issues one draw per range.
+// Has no graphics API dependency and can be used without a window.
+class GeometryBatcher
+{
+public:
+    GeometryBatcher();
+
+    void SetOrder(BatchOrder order) { this->order = order; }
+    BatchOrder GetOrder() const { return order; }
+
+    // State applied to primitives added after the call. Rotation is in degrees, as in SetTransform.
+    void SetTransform(float x, float y, float rotation, float scale);
+    void SetColor(float r, float g, float b, float a);
+    void SetShader(unsigned int shaderId) { currentKey.shaderId = shaderId; }
+    void SetTexture(unsigned int textureId) { currentKey.textureId = textureId; }
+    // Layers draw in ascending order in both orders; the order only decides what happens inside a layer
+    void SetLayer(uint32_t layer) { currentKey.layer = layer; }
+
+    void AddQuad(float x, float y, float width, float height);
+    void AddTriangle(float x1, float y1, float x2, float y2, float x3, float y3);
+    void AddCircle(float centerX, float centerY, float radius, int segments);
+
+    bool IsEmpty() const { return primitives.empty(); }
+
+    // Produces the vertex, index and range streams. The streams stay valid until Clear.
+    void Build();
+    const std::vector<BatchVertex>& GetVertices() const { return vertices; }
+    const std::vector<uint32_t>& GetIndices() const { return indices; }
+    const std::vector<BatchDrawRange>& GetDrawRanges() const { return drawRanges; }
+
+    // Drops all primitives but keeps the current state and the allocated capacity
+    void Clear();
+
+    GeometryBatcherStats GetStats() const;
+
+private:
+    // Where one Add call landed in the submission streams
+    struct Primitive
+    {
+        BatchStateKey key;
+        uint32_t firstVertex;
+        uint32_t vertexCount;
+        uint32_t firstIndex;
+        uint32_t indexCount;
+    };
+
+    BatchVertex* AppendVertices(uint32_t count);
+    uint32_t* AppendIndices(uint32_t count);
+    void WriteVertex(BatchVertex& vertex, float x, float y, float u, float v) const;
+    // Stable sort by layer only, or by the whole key for StateSorted
+    void SortPrimitives(bool byState);
+    void BuildRanges();
+    const std::vector<float>& GetUnitCircle(int segments);
+
+    BatchOrder order;
+    BatchStateKey currentKey;
+    float color[4];
+
+    // Transform as a 2x2 matrix plus translation, so each vertex costs four multiplies
+    float m00, m01, m10, m11;
+    float translateX, translateY;
+
+    std::vector<Primitive> primitives;
+    std::vector<BatchVertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<BatchDrawRange> drawRanges;
+    bool built;
+
+    // Scratch for sorted builds, kept to reuse the allocation
+    std::vector<uint32_t> sortOrder;
+    std::vector<Primitive> sortedPrimitives;
+    std::vector<BatchVertex> sortedVertices;
+    std::vector<uint32_t> sortedIndices;
+
+    // cos/sin pairs of the rim points per segment count
+    std::unordered_map<int, std::vector<float>> unitCircles;
+};
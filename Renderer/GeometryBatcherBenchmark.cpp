@@ -0,0 +1,158 @@
+#include "GeometryBatcher.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Headless checks and timings for GeometryBatcher: range merging, StateSorted grouping,
+// index rebasing and layer order, then Build time for growing primitive counts.
+// Returns non-zero if any check fails.
+namespace
+{
+    int failures = 0;
+
+    void Check(bool condition, const char* what)
+    {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            failures++;
+        }
+    }
+
+    // Every index must point at a vertex whose x lies inside the quad it was added for
+    bool IndicesInside(const GeometryBatcher& batcher, const BatchDrawRange& range, float minX, float maxX)
+    {
+        const std::vector<BatchVertex>& vertices = batcher.GetVertices();
+        const std::vector<uint32_t>& indices = batcher.GetIndices();
+        for (uint32_t i = range.firstIndex; i < range.firstIndex + range.indexCount; i++) {
+            if (indices[i] >= vertices.size() || vertices[indices[i]].x < minX || vertices[indices[i]].x > maxX) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void CheckMerging()
+    {
+        GeometryBatcher batcher;
+        batcher.SetTexture(1);
+        batcher.AddQuad(0.0f, 0.0f, 10.0f, 10.0f);
+        batcher.AddQuad(20.0f, 0.0f, 10.0f, 10.0f);
+        batcher.AddTriangle(40.0f, 0.0f, 50.0f, 0.0f, 40.0f, 10.0f);
+        batcher.Build();
+
+        const std::vector<BatchDrawRange>& ranges = batcher.GetDrawRanges();
+        Check(ranges.size() == 1, "neighbours with one key merge into a single range");
+        Check(ranges.size() == 1 && ranges[0].firstIndex == 0 && ranges[0].indexCount == 15,
+              "merged range covers all indices");
+        Check(batcher.GetVertices().size() == 11, "quads add four vertices, triangles three");
+
+        batcher.Clear();
+        batcher.AddCircle(0.0f, 0.0f, 5.0f, 16);
+        batcher.Build();
+        Check(batcher.GetVertices().size() == 17 && batcher.GetIndices().size() == 48,
+              "circle is a center plus one vertex per segment");
+    }
+
+    void CheckStateSorted()
+    {
+        // Textures 1, 2, 1: three ranges in submission order, two when sorted
+        GeometryBatcher batcher;
+        for (int pass = 0; pass < 2; pass++) {
+            batcher.Clear();
+            batcher.SetOrder(pass == 0 ? BatchOrder::Submission : BatchOrder::StateSorted);
+            batcher.SetTexture(1);
+            batcher.AddQuad(0.0f, 0.0f, 10.0f, 10.0f);
+            batcher.SetTexture(2);
+            batcher.AddQuad(100.0f, 0.0f, 10.0f, 10.0f);
+            batcher.SetTexture(1);
+            batcher.AddQuad(200.0f, 0.0f, 10.0f, 10.0f);
+            batcher.Build();
+
+            const std::vector<BatchDrawRange>& ranges = batcher.GetDrawRanges();
+            if (pass == 0) {
+                Check(ranges.size() == 3, "submission order keeps key changes");
+                continue;
+            }
+
+            Check(ranges.size() == 2, "StateSorted groups equal textures");
+            if (ranges.size() != 2) {
+                continue;
+            }
+            Check(ranges[0].key.textureId == 1 && ranges[0].indexCount == 12, "texture 1 range holds both quads");
+            Check(ranges[1].key.textureId == 2 && ranges[1].firstIndex == 12, "texture 2 range follows");
+
+            // The third quad moved from vertex 8 to vertex 4; its indices must have moved with it
+            BatchDrawRange firstQuad = {ranges[0].key, 0, 6};
+            BatchDrawRange movedQuad = {ranges[0].key, 6, 6};
+            Check(IndicesInside(batcher, firstQuad, 0.0f, 10.0f), "first quad indices unchanged");
+            Check(IndicesInside(batcher, movedQuad, 200.0f, 210.0f), "moved quad indices rebased");
+            Check(IndicesInside(batcher, ranges[1], 100.0f, 110.0f), "texture 2 quad indices rebased");
+        }
+    }
+
+    void CheckLayers()
+    {
+        for (int pass = 0; pass < 2; pass++) {
+            GeometryBatcher batcher;
+            batcher.SetOrder(pass == 0 ? BatchOrder::Submission : BatchOrder::StateSorted);
+            batcher.SetLayer(1);
+            batcher.AddQuad(100.0f, 0.0f, 10.0f, 10.0f);
+            batcher.SetLayer(0);
+            batcher.AddQuad(0.0f, 0.0f, 10.0f, 10.0f);
+            batcher.Build();
+
+            const std::vector<BatchDrawRange>& ranges = batcher.GetDrawRanges();
+            bool ordered = ranges.size() == 2 && ranges[0].key.layer == 0 && ranges[1].key.layer == 1 &&
+                           IndicesInside(batcher, ranges[0], 0.0f, 10.0f) &&
+                           IndicesInside(batcher, ranges[1], 100.0f, 110.0f);
+            Check(ordered, pass == 0 ? "submission order draws lower layers first"
+                                     : "StateSorted draws lower layers first");
+        }
+    }
+
+    void RunBenchmark()
+    {
+        std::printf("\n%10s %14s %10s %14s %10s\n", "primitives", "submit ms", "draws", "sorted ms", "draws");
+
+        const int counts[] = {1000, 10000, 100000};
+        for (int count : counts) {
+            double buildMs[2] = {0.0, 0.0};
+            uint32_t draws[2] = {0, 0};
+            for (int pass = 0; pass < 2; pass++) {
+                GeometryBatcher batcher;
+                batcher.SetOrder(pass == 0 ? BatchOrder::Submission : BatchOrder::StateSorted);
+                std::mt19937 rng(1234);
+                std::uniform_int_distribution<int> texture(1, 8);
+                std::uniform_real_distribution<float> position(0.0f, 1920.0f);
+
+                // Same primitives every repeat; Clear keeps the capacity, as a renderer does per frame
+                const int repeats = 5;
+                for (int repeat = 0; repeat < repeats; repeat++) {
+                    batcher.Clear();
+                    for (int i = 0; i < count; i++) {
+                        batcher.SetTexture(texture(rng));
+                        batcher.AddQuad(position(rng), position(rng), 16.0f, 16.0f);
+                    }
+                    auto start = std::chrono::steady_clock::now();
+                    batcher.Build();
+                    buildMs[pass] += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                }
+                buildMs[pass] /= repeats;
+                draws[pass] = batcher.GetStats().drawCount;
+            }
+            std::printf("%10d %14.3f %10u %14.3f %10u\n", count, buildMs[0], draws[0], buildMs[1], draws[1]);
+        }
+    }
+}
+
+int main()
+{
+    std::printf("GeometryBatcher checks\n");
+    CheckMerging();
+    CheckStateSorted();
+    CheckLayers();
+    std::printf("%s\n", failures == 0 ? "all checks passed" : "checks FAILED");
+
+    RunBenchmark();
+    return failures == 0 ? 0 : 1;
+}
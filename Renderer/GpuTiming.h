@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// 单个命名GPU计时范围的结果
+struct GpuScopeTiming
+{
+    std::string name;
+    double milliseconds;
+};
+
+// 一帧的GPU计时结果（在若干帧之后才能读回）
+struct GpuFrameTiming
+{
+    uint64_t frameIndex;                 // 帧序号
+    double gpuMilliseconds;              // BeginFrame到EndFrame之间的GPU耗时
+    double cpuMilliseconds;              // 同一帧BeginFrame到EndFrame之间的CPU耗时
+    std::vector<GpuScopeTiming> scopes;  // 帧内各命名范围的GPU耗时（按开始顺序）
+
+    // GPU耗时超过CPU录制耗时时，该帧受GPU限制
+    bool IsGpuBound() const { return gpuMilliseconds > cpuMilliseconds; }
+};
@@ -1,5 +1,10 @@
 #pragma once
+#ifdef _WIN32
 #include <windows.h>
+#else
+// 非Windows平台（如Linux CI上的离屏Vulkan渲染）没有窗口句柄类型
+typedef void* HWND;
+#endif
 #include <string>
 
 // 渲染器接口
@@ -0,0 +1,218 @@
+#include "OpenGLGpuTimer.h"
+#include <windows.h>
+#include <gl/GL.h>
+
+OpenGLGpuTimer::OpenGLGpuTimer()
+    : m_available(false), m_inFrame(false), m_frameCounter(0), m_droppedFrames(0)
+    , m_hasLastTiming(false)
+{
+    for (unsigned int i = 0; i < kFrameLatency; ++i)
+    {
+        m_frames[i].frameIndex = 0;
+        m_frames[i].pending = false;
+        m_frames[i].scopeCount = 0;
+        m_frames[i].cpuMilliseconds = 0.0;
+    }
+    m_lastTiming.frameIndex = 0;
+    m_lastTiming.gpuMilliseconds = 0.0;
+    m_lastTiming.cpuMilliseconds = 0.0;
+}
+
+OpenGLGpuTimer::~OpenGLGpuTimer()
+{
+    // Query objects belong to the GL context; the owner calls Cleanup while it is current
+}
+
+bool OpenGLGpuTimer::Initialize()
+{
+    // Timer queries are core since GL 3.3 (ARB_timer_query)
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    if (!version || version[0] < '3' || (version[0] == '3' && version[2] < '3'))
+    {
+        m_available = false;
+        return false;
+    }
+    
+    GLint counterBits = 0;
+    glGetQueryiv(GL_TIMESTAMP, GL_QUERY_COUNTER_BITS, &counterBits);
+    m_available = counterBits > 0;
+    return m_available;
+}
+
+void OpenGLGpuTimer::Cleanup()
+{
+    for (unsigned int i = 0; i < kFrameLatency; ++i)
+    {
+        for (auto& scope : m_frames[i].scopes)
+        {
+            glDeleteQueries(1, &scope.beginQuery);
+            glDeleteQueries(1, &scope.endQuery);
+        }
+        m_frames[i].scopes.clear();
+        m_frames[i].scopeCount = 0;
+        m_frames[i].pending = false;
+    }
+    m_openScopes.clear();
+    m_inFrame = false;
+    m_available = false;
+}
+
+void OpenGLGpuTimer::BeginFrame()
+{
+    if (!m_available)
+    {
+        return;
+    }
+    
+    // Read back every finished frame in submission order. Queries complete in order,
+    // so the first frame that is not ready means the later ones are not ready either.
+    uint64_t oldest = m_frameCounter >= kFrameLatency ? m_frameCounter - kFrameLatency : 0;
+    for (uint64_t frame = oldest; frame < m_frameCounter; ++frame)
+    {
+        FrameSlot& slot = m_frames[frame % kFrameLatency];
+        if (slot.pending && slot.frameIndex == frame && !TryResolve(slot))
+        {
+            break;
+        }
+    }
+    
+    // The slot we are about to reuse is still in flight: drop its results instead of stalling
+    FrameSlot& slot = m_frames[m_frameCounter % kFrameLatency];
+    if (slot.pending)
+    {
+        slot.pending = false;
+        ++m_droppedFrames;
+    }
+    
+    slot.frameIndex = m_frameCounter;
+    slot.scopeCount = 0;
+    slot.cpuMilliseconds = 0.0;
+    m_openScopes.clear();
+    m_inFrame = true;
+    m_frameStart = std::chrono::steady_clock::now();
+    
+    BeginScope("Frame");
+}
+
+void OpenGLGpuTimer::EndFrame()
+{
+    if (!m_available || !m_inFrame)
+    {
+        return;
+    }
+    
+    // Close any scope the caller left open, including the frame scope
+    while (!m_openScopes.empty())
+    {
+        EndScope();
+    }
+    
+    FrameSlot& slot = m_frames[m_frameCounter % kFrameLatency];
+    slot.cpuMilliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - m_frameStart).count();
+    slot.pending = true;
+    
+    m_inFrame = false;
+    ++m_frameCounter;
+}
+
+void OpenGLGpuTimer::BeginScope(const char* name)
+{
+    if (!m_available || !m_inFrame)
+    {
+        return;
+    }
+    
+    FrameSlot& slot = m_frames[m_frameCounter % kFrameLatency];
+    if (slot.scopeCount == slot.scopes.size())
+    {
+        ScopeQuery query;
+        glGenQueries(1, &query.beginQuery);
+        glGenQueries(1, &query.endQuery);
+        slot.scopes.push_back(query);
+    }
+    
+    // Timestamps rather than GL_TIME_ELAPSED, because elapsed-time queries cannot nest
+    ScopeQuery& scope = slot.scopes[slot.scopeCount];
+    scope.name = name;
+    scope.closed = false;
+    glQueryCounter(scope.beginQuery, GL_TIMESTAMP);
+    
+    m_openScopes.push_back(slot.scopeCount);
+    ++slot.scopeCount;
+}
+
+void OpenGLGpuTimer::EndScope()
+{
+    if (!m_available || !m_inFrame || m_openScopes.empty())
+    {
+        return;
+    }
+    
+    FrameSlot& slot = m_frames[m_frameCounter % kFrameLatency];
+    ScopeQuery& scope = slot.scopes[m_openScopes.back()];
+    glQueryCounter(scope.endQuery, GL_TIMESTAMP);
+    scope.closed = true;
+    m_openScopes.pop_back();
+}
+
+bool OpenGLGpuTimer::GetLastFrameTiming(GpuFrameTiming& timing) const
+{
+    if (!m_hasLastTiming)
+    {
+        return false;
+    }
+    
+    timing = m_lastTiming;
+    return true;
+}
+
+bool OpenGLGpuTimer::TryResolve(FrameSlot& slot)
+{
+    if (slot.scopeCount == 0)
+    {
+        slot.pending = false;
+        return true;
+    }
+    
+    // The frame scope is closed last, so its end query finishing means all others have
+    GLint available = 0;
+    glGetQueryObjectiv(slot.scopes[0].endQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        return false;
+    }
+    
+    m_lastTiming.frameIndex = slot.frameIndex;
+    m_lastTiming.cpuMilliseconds = slot.cpuMilliseconds;
+    m_lastTiming.gpuMilliseconds = 0.0;
+    m_lastTiming.scopes.clear();
+    
+    for (size_t i = 0; i < slot.scopeCount; ++i)
+    {
+        const ScopeQuery& scope = slot.scopes[i];
+        if (!scope.closed)
+        {
+            continue;
+        }
+        
+        GLuint64 beginTime = 0;
+        GLuint64 endTime = 0;
+        glGetQueryObjectui64v(scope.beginQuery, GL_QUERY_RESULT, &beginTime);
+        glGetQueryObjectui64v(scope.endQuery, GL_QUERY_RESULT, &endTime);
+        
+        double milliseconds = endTime > beginTime ? (endTime - beginTime) / 1000000.0 : 0.0;
+        if (i == 0)
+        {
+            m_lastTiming.gpuMilliseconds = milliseconds;
+        }
+        else
+        {
+            m_lastTiming.scopes.push_back({ scope.name, milliseconds });
+        }
+    }
+    
+    m_hasLastTiming = true;
+    slot.pending = false;
+    return true;
+}
@@ -0,0 +1,67 @@
+#pragma once
+#include "GpuTiming.h"
+#include <chrono>
+#include <string>
+#include <vector>
+
+// 基于GL_TIMESTAMP查询对象环的非阻塞GPU计时器
+// 每帧的查询结果在若干帧之后读回，CPU从不等待GPU
+class OpenGLGpuTimer
+{
+public:
+    // 查询环的长度（结果最多延迟这么多帧）
+    static const unsigned int kFrameLatency = 4;
+
+    OpenGLGpuTimer();
+    ~OpenGLGpuTimer();
+
+    // 需要当前线程上有激活的OpenGL上下文
+    bool Initialize();
+    void Cleanup();
+    bool IsAvailable() const { return m_available; }
+
+    // 帧开始/结束，自动包裹一个名为"Frame"的范围
+    void BeginFrame();
+    void EndFrame();
+
+    // 帧内的命名范围，可以嵌套
+    void BeginScope(const char* name);
+    void EndScope();
+
+    // 获取最近一次已读回的帧计时结果
+    bool GetLastFrameTiming(GpuFrameTiming& timing) const;
+
+    // 因查询结果未就绪而被丢弃的帧数
+    uint64_t GetDroppedFrameCount() const { return m_droppedFrames; }
+
+private:
+    struct ScopeQuery
+    {
+        std::string name;
+        unsigned int beginQuery;
+        unsigned int endQuery;
+        bool closed;
+    };
+
+    struct FrameSlot
+    {
+        uint64_t frameIndex;
+        bool pending;
+        size_t scopeCount;
+        double cpuMilliseconds;
+        std::vector<ScopeQuery> scopes;  // 查询对象在帧间复用，只增不减
+    };
+
+    bool TryResolve(FrameSlot& slot);
+
+    bool m_available;
+    bool m_inFrame;
+    uint64_t m_frameCounter;
+    uint64_t m_droppedFrames;
+    FrameSlot m_frames[kFrameLatency];
+    std::vector<size_t> m_openScopes;
+    std::chrono::steady_clock::time_point m_frameStart;
+
+    bool m_hasLastTiming;
+    GpuFrameTiming m_lastTiming;
+};
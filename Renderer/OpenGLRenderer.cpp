@@ -1,14 +1,60 @@
 #include "OpenGLRenderer.h"
 #include <cmath>
+#include <cstddef>
+
+namespace
+{
+    // Circles are drawn as instanced triangle fans: the unit mesh is scaled by the
+    // per-instance radius and offset by the per-instance center in the vertex shader.
+    const char* kCircleVertexShader = R"(
+        #version 330 core
+        layout (location = 0) in vec2 aUnitPos;
+        layout (location = 1) in vec3 aCenterRadius;
+        layout (location = 2) in vec4 aColor;
+        
+        uniform vec2 viewportSize;
+        
+        out vec4 Color;
+        
+        void main()
+        {
+            vec2 pos = aCenterRadius.xy + aUnitPos * aCenterRadius.z;
+            gl_Position = vec4(pos.x / viewportSize.x * 2.0 - 1.0, 1.0 - pos.y / viewportSize.y * 2.0, 0.0, 1.0);
+            Color = aColor;
+        }
+    )";
+    
+    const char* kCircleFragmentShader = R"(
+        #version 330 core
+        out vec4 FragColor;
+        
+        in vec4 Color;
+        
+        void main()
+        {
+            FragColor = Color;
+        }
+    )";
+    
+    const float kPi = 3.14159265359f;
+}
 
 OpenGLRenderer::OpenGLRenderer() 
     : m_hwnd(nullptr), m_hdc(nullptr), m_hglrc(nullptr)
     , m_transformX(0.0f), m_transformY(0.0f), m_rotation(0.0f), m_scale(1.0f)
+    , m_currentShader(0), m_surfaceWidth(0), m_surfaceHeight(0)
+    , m_circleBatchSegments(0), m_circleVao(0), m_circleInstanceVbo(0)
+    , m_circleInstanceCapacity(0), m_circleProgram(0), m_circleViewportLocation(-1)
 {
     m_clearColor[0] = 0.0f;
     m_clearColor[1] = 0.0f;
     m_clearColor[2] = 0.0f;
     m_clearColor[3] = 1.0f;
+    
+    m_drawColor[0] = 1.0f;
+    m_drawColor[1] = 1.0f;
+    m_drawColor[2] = 1.0f;
+    m_drawColor[3] = 1.0f;
 }
 
 OpenGLRenderer::~OpenGLRenderer()
@@ -75,11 +121,25 @@ bool OpenGLRenderer::Initialize(HWND hwnd)
     // 设置正交投影
     RECT rect;
     GetClientRect(m_hwnd, &rect);
-    gluOrtho2D(0.0, (GLdouble)(rect.right - rect.left), (GLdouble)(rect.bottom - rect.top), 0.0);
+    m_surfaceWidth = (unsigned int)(rect.right - rect.left);
+    m_surfaceHeight = (unsigned int)(rect.bottom - rect.top);
+    gluOrtho2D(0.0, (GLdouble)m_surfaceWidth, (GLdouble)m_surfaceHeight, 0.0);
     
     glMatrixMode(GL_MODELVIEW);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glColor4fv(m_drawColor);
+    
+    // Instanced circles need GL 3.3; without them DrawCircle falls back to immediate mode
+    if (!CreateCircleResources())
+    {
+        OutputDebugStringA("OpenGLRenderer: instanced circle path unavailable, using immediate mode\n");
+    }
+    
+    if (!m_gpuTimer.Initialize())
+    {
+        OutputDebugStringA("OpenGLRenderer: GL_TIMESTAMP queries unavailable, GPU timing disabled\n");
+    }
     
     return true;
 }
@@ -88,6 +148,9 @@ void OpenGLRenderer::Cleanup()
 {
     if (m_hglrc)
     {
+        m_batcher.Clear();
+        DestroyCircleResources();
+        m_gpuTimer.Cleanup();
         wglMakeCurrent(nullptr, nullptr);
         wglDeleteContext(m_hglrc);
         m_hglrc = nullptr;
@@ -102,12 +165,16 @@ void OpenGLRenderer::Cleanup()
 
 void OpenGLRenderer::BeginFrame()
 {
+    m_gpuTimer.BeginFrame();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glLoadIdentity();
 }
 
 void OpenGLRenderer::EndFrame()
 {
+    FlushGeometryBatch();
+    FlushCircleBatch();
+    m_gpuTimer.EndFrame();
     SwapBuffers(m_hdc);
 }
 
@@ -122,55 +189,52 @@ void OpenGLRenderer::SetClearColor(float r, float g, float b, float a)
 
 void OpenGLRenderer::DrawQuad(float x, float y, float width, float height)
 {
-    glPushMatrix();
-    glTranslatef(m_transformX, m_transformY, 0.0f);
-    glRotatef(m_rotation, 0.0f, 0.0f, 1.0f);
-    glScalef(m_scale, m_scale, 1.0f);
-    
-    glBegin(GL_QUADS);
-    glVertex2f(x, y);
-    glVertex2f(x + width, y);
-    glVertex2f(x + width, y + height);
-    glVertex2f(x, y + height);
-    glEnd();
-    
-    glPopMatrix();
+    FlushCircleBatch();
+    m_batcher.AddQuad(x, y, width, height);
 }
 
 void OpenGLRenderer::DrawTriangle(float x1, float y1, float x2, float y2, float x3, float y3)
 {
-    glPushMatrix();
-    glTranslatef(m_transformX, m_transformY, 0.0f);
-    glRotatef(m_rotation, 0.0f, 0.0f, 1.0f);
-    glScalef(m_scale, m_scale, 1.0f);
-    
-    glBegin(GL_TRIANGLES);
-    glVertex2f(x1, y1);
-    glVertex2f(x2, y2);
-    glVertex2f(x3, y3);
-    glEnd();
-    
-    glPopMatrix();
+    FlushCircleBatch();
+    m_batcher.AddTriangle(x1, y1, x2, y2, x3, y3);
 }
 
 void OpenGLRenderer::DrawCircle(float centerX, float centerY, float radius, int segments)
 {
-    glPushMatrix();
-    glTranslatef(m_transformX, m_transformY, 0.0f);
-    glRotatef(m_rotation, 0.0f, 0.0f, 1.0f);
-    glScalef(m_scale, m_scale, 1.0f);
+    segments = std::max(segments, 3);
     
-    glBegin(GL_LINE_LOOP);
-    for (int i = 0; i < segments; ++i)
+    if (m_circleProgram == 0)
     {
-        float angle = 2.0f * 3.14159265359f * i / segments;
-        float x = centerX + cosf(angle) * radius;
-        float y = centerY + sinf(angle) * radius;
-        glVertex2f(x, y);
+        // Without the instanced path circles go through the geometry batch like quads
+        m_batcher.AddCircle(centerX, centerY, radius, segments);
+        return;
     }
-    glEnd();
     
-    glPopMatrix();
+    FlushGeometryBatch();
+    
+    // Consecutive circles with the same segment count share one instanced draw
+    if (segments != m_circleBatchSegments)
+    {
+        FlushCircleBatch();
+        m_circleBatchSegments = segments;
+    }
+    
+    // Apply the translate/rotate/scale transform on the CPU; rotation only moves the center
+    float angle = m_rotation * kPi / 180.0f;
+    float cosAngle = cosf(angle);
+    float sinAngle = sinf(angle);
+    float scaledX = centerX * m_scale;
+    float scaledY = centerY * m_scale;
+    
+    CircleInstance instance;
+    instance.centerX = m_transformX + scaledX * cosAngle - scaledY * sinAngle;
+    instance.centerY = m_transformY + scaledX * sinAngle + scaledY * cosAngle;
+    instance.radius = radius * fabsf(m_scale);
+    instance.color[0] = m_drawColor[0];
+    instance.color[1] = m_drawColor[1];
+    instance.color[2] = m_drawColor[2];
+    instance.color[3] = m_drawColor[3];
+    m_circleInstances.push_back(instance);
 }
 
 void OpenGLRenderer::SetTransform(float x, float y, float rotation, float scale)
@@ -179,6 +243,7 @@ void OpenGLRenderer::SetTransform(float x, float y, float rotation, float scale)
     m_transformY = y;
     m_rotation = rotation;
     m_scale = scale;
+    m_batcher.SetTransform(x, y, rotation, scale);
 }
 
 unsigned int OpenGLRenderer::LoadTexture(const std::string& filename)
@@ -246,6 +311,12 @@ unsigned int OpenGLRenderer::LoadTexture(const std::string& filename)
 }
 
 void OpenGLRenderer::UseTexture(unsigned int textureId)
+{
+    // Bound when the geometry batch is drawn; instanced circles do not sample textures
+    m_batcher.SetTexture(textureId);
+}
+
+void OpenGLRenderer::BindTexture(unsigned int textureId)
 {
     if (textureId != 0)
     {
@@ -297,12 +368,67 @@ unsigned int OpenGLRenderer::LoadShader(const std::string& vertexShaderFile, con
         )";
     }
     
-    const char* vShaderCode = vertexCode.c_str();
-    const char* fShaderCode = fragmentCode.c_str();
+    return CompileShaderProgram(vertexCode.c_str(), fragmentCode.c_str());
+}
+
+void OpenGLRenderer::UseShader(unsigned int shaderId)
+{
+    // Pending circles restore m_currentShader when they flush, so they go out first
+    FlushCircleBatch();
+    
+    m_currentShader = shaderId;
+    m_batcher.SetShader(shaderId);
+}
+
+void OpenGLRenderer::SetSurface(unsigned int width, unsigned int height)
+{
+    // 在实际实现中，这里需要调整渲染表面大小
+    // 例如重新配置视口、投影矩阵等
+    FlushGeometryBatch();
+    FlushCircleBatch();
+    m_surfaceWidth = width;
+    m_surfaceHeight = height;
+    glViewport(0, 0, width, height);
+    glMatrixMode(GL_PROJECTION);
+    glLoadIdentity();
+    gluOrtho2D(0.0, (GLdouble)width, (GLdouble)height, 0.0);
+    glMatrixMode(GL_MODELVIEW);
+}
+
+std::string OpenGLRenderer::ReadShaderFile(const std::string& filePath)
+{
+    std::string content;
+    std::ifstream fileStream(filePath, std::ios::in);
+    
+    if (!fileStream.is_open()) {
+        // Return empty string if file cannot be opened
+        return content;
+    }
+    
+    std::string line = "";
+    while (std::getline(fileStream, line)) {
+        content.append(line + "\n");
+    }
     
+    fileStream.close();
+    return content;
+}
+
+void OpenGLRenderer::SetDrawColor(float r, float g, float b, float a)
+{
+    m_drawColor[0] = r;
+    m_drawColor[1] = g;
+    m_drawColor[2] = b;
+    m_drawColor[3] = a;
+    glColor4f(r, g, b, a);
+    m_batcher.SetColor(r, g, b, a);
+}
+
+unsigned int OpenGLRenderer::CompileShaderProgram(const char* vertexSource, const char* fragmentSource)
+{
     // Compile vertex shader
     unsigned int vertex = glCreateShader(GL_VERTEX_SHADER);
-    glShaderSource(vertex, 1, &vShaderCode, NULL);
+    glShaderSource(vertex, 1, &vertexSource, NULL);
     glCompileShader(vertex);
     
     // Check for vertex shader compilation errors
@@ -316,7 +442,7 @@ unsigned int OpenGLRenderer::LoadShader(const std::string& vertexShaderFile, con
     
     // Compile fragment shader
     unsigned int fragment = glCreateShader(GL_FRAGMENT_SHADER);
-    glShaderSource(fragment, 1, &fShaderCode, NULL);
+    glShaderSource(fragment, 1, &fragmentSource, NULL);
     glCompileShader(fragment);
     
     // Check for fragment shader compilation errors
@@ -346,41 +472,219 @@ unsigned int OpenGLRenderer::LoadShader(const std::string& vertexShaderFile, con
     return shaderProgram;
 }
 
-void OpenGLRenderer::UseShader(unsigned int shaderId)
+bool OpenGLRenderer::CreateCircleResources()
 {
-    if (shaderId != 0) {
-        glUseProgram(shaderId);
-    } else {
-        glUseProgram(0);
+    const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    if (!version || version[0] < '3' || (version[0] == '3' && version[2] < '3'))
+    {
+        return false;
     }
+    
+    unsigned int program = CompileShaderProgram(kCircleVertexShader, kCircleFragmentShader);
+    int linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glDeleteProgram(program);
+        return false;
+    }
+    
+    m_circleProgram = program;
+    m_circleViewportLocation = glGetUniformLocation(m_circleProgram, "viewportSize");
+    
+    glGenVertexArrays(1, &m_circleVao);
+    glGenBuffers(1, &m_circleInstanceVbo);
+    
+    // Instance attributes never change layout, so they are captured in the VAO once;
+    // only the per-vertex unit mesh binding is switched per segment count
+    glBindVertexArray(m_circleVao);
+    glBindBuffer(GL_ARRAY_BUFFER, m_circleInstanceVbo);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, centerX));
+    glVertexAttribDivisor(1, 1);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(CircleInstance), (void*)offsetof(CircleInstance, color));
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(0);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    
+    return true;
 }
 
-void OpenGLRenderer::SetSurface(unsigned int width, unsigned int height)
+void OpenGLRenderer::DestroyCircleResources()
 {
-    // 在实际实现中，这里需要调整渲染表面大小
-    // 例如重新配置视口、投影矩阵等
-    glViewport(0, 0, width, height);
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    gluOrtho2D(0.0, (GLdouble)width, (GLdouble)height, 0.0);
-    glMatrixMode(GL_MODELVIEW);
+    for (auto& meshPair : m_unitCircleMeshes)
+    {
+        if (meshPair.second.vbo != 0)
+        {
+            glDeleteBuffers(1, &meshPair.second.vbo);
+        }
+    }
+    m_unitCircleMeshes.clear();
+    m_circleInstances.clear();
+    m_circleBatchSegments = 0;
+    
+    if (m_circleInstanceVbo != 0)
+    {
+        glDeleteBuffers(1, &m_circleInstanceVbo);
+        m_circleInstanceVbo = 0;
+    }
+    m_circleInstanceCapacity = 0;
+    
+    if (m_circleVao != 0)
+    {
+        glDeleteVertexArrays(1, &m_circleVao);
+        m_circleVao = 0;
+    }
+    
+    if (m_circleProgram != 0)
+    {
+        glDeleteProgram(m_circleProgram);
+        m_circleProgram = 0;
+    }
 }
 
-std::string OpenGLRenderer::ReadShaderFile(const std::string& filePath)
+OpenGLRenderer::UnitCircleMesh& OpenGLRenderer::GetUnitCircleMesh(int segments)
 {
-    std::string content;
-    std::ifstream fileStream(filePath, std::ios::in);
+    auto it = m_unitCircleMeshes.find(segments);
+    if (it != m_unitCircleMeshes.end())
+    {
+        return it->second;
+    }
     
-    if (!fileStream.is_open()) {
-        // Return empty string if file cannot be opened
-        return content;
+    // Triangle fan: center, then segments + 1 rim points so the fan closes on itself
+    UnitCircleMesh mesh;
+    mesh.vbo = 0;
+    mesh.vertices.reserve((segments + 2) * 2);
+    mesh.vertices.push_back(0.0f);
+    mesh.vertices.push_back(0.0f);
+    for (int i = 0; i <= segments; ++i)
+    {
+        float angle = 2.0f * kPi * i / segments;
+        mesh.vertices.push_back(cosf(angle));
+        mesh.vertices.push_back(sinf(angle));
     }
     
-    std::string line = "";
-    while (std::getline(fileStream, line)) {
-        content.append(line + "\n");
+    if (m_circleProgram != 0)
+    {
+        glGenBuffers(1, &mesh.vbo);
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+        glBufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
     }
     
-    fileStream.close();
-    return content;
+    return m_unitCircleMeshes.emplace(segments, std::move(mesh)).first->second;
+}
+
+void OpenGLRenderer::FlushCircleBatch()
+{
+    if (m_circleInstances.empty())
+    {
+        return;
+    }
+    
+    m_gpuTimer.BeginScope("CircleBatch");
+    
+    const UnitCircleMesh& mesh = GetUnitCircleMesh(m_circleBatchSegments);
+    
+    // Upload instance data, orphaning the previous storage so the driver never waits on it
+    size_t instanceBytes = m_circleInstances.size() * sizeof(CircleInstance);
+    glBindBuffer(GL_ARRAY_BUFFER, m_circleInstanceVbo);
+    if (instanceBytes > m_circleInstanceCapacity)
+    {
+        m_circleInstanceCapacity = std::max(instanceBytes, m_circleInstanceCapacity * 2);
+    }
+    glBufferData(GL_ARRAY_BUFFER, m_circleInstanceCapacity, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, instanceBytes, m_circleInstances.data());
+    
+    glBindVertexArray(m_circleVao);
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.vbo);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), (void*)0);
+    
+    glUseProgram(m_circleProgram);
+    glUniform2f(m_circleViewportLocation, (float)std::max(m_surfaceWidth, 1u), (float)std::max(m_surfaceHeight, 1u));
+    
+    glDrawArraysInstanced(GL_TRIANGLE_FAN, 0, (GLsizei)(mesh.vertices.size() / 2), (GLsizei)m_circleInstances.size());
+    
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    glUseProgram(m_currentShader);
+    
+    m_circleInstances.clear();
+    
+    m_gpuTimer.EndScope();
+}
+
+void OpenGLRenderer::FlushGeometryBatch()
+{
+    if (m_batcher.IsEmpty())
+    {
+        return;
+    }
+    
+    m_gpuTimer.BeginScope("GeometryBatch");
+    
+    m_batcher.Build();
+    const std::vector<BatchVertex>& vertices = m_batcher.GetVertices();
+    const std::vector<uint32_t>& indices = m_batcher.GetIndices();
+    
+    // Client arrays work on every context, including the ones without the instanced circle path;
+    // the transform is already applied, so the modelview matrix stays identity
+    const GLsizei stride = sizeof(BatchVertex);
+    glEnableClientState(GL_VERTEX_ARRAY);
+    glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+    glEnableClientState(GL_COLOR_ARRAY);
+    glVertexPointer(3, GL_FLOAT, stride, &vertices[0].x);
+    glTexCoordPointer(2, GL_FLOAT, stride, &vertices[0].u);
+    glColorPointer(4, GL_FLOAT, stride, vertices[0].color);
+    
+    bool first = true;
+    BatchStateKey bound = {};
+    for (const BatchDrawRange& range : m_batcher.GetDrawRanges())
+    {
+        if (first || range.key.shaderId != bound.shaderId)
+        {
+            glUseProgram(range.key.shaderId);
+        }
+        if (first || range.key.textureId != bound.textureId)
+        {
+            BindTexture(range.key.textureId);
+        }
+        bound = range.key;
+        first = false;
+        glDrawElements(GL_TRIANGLES, (GLsizei)range.indexCount, GL_UNSIGNED_INT, &indices[range.firstIndex]);
+    }
+    
+    glDisableClientState(GL_COLOR_ARRAY);
+    glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+    glDisableClientState(GL_VERTEX_ARRAY);
+    
+    // The current color is undefined after drawing with a color array
+    glColor4fv(m_drawColor);
+    glUseProgram(m_currentShader);
+    
+    m_batcher.Clear();
+    
+    m_gpuTimer.EndScope();
+}
+
+void OpenGLRenderer::BeginGpuScope(const char* name)
+{
+    // Pending geometry belongs to whatever scope was open when it was drawn
+    FlushGeometryBatch();
+    FlushCircleBatch();
+    m_gpuTimer.BeginScope(name);
+}
+
+void OpenGLRenderer::EndGpuScope()
+{
+    FlushGeometryBatch();
+    FlushCircleBatch();
+    m_gpuTimer.EndScope();
+}
+
+bool OpenGLRenderer::GetLastGpuFrameTiming(GpuFrameTiming& timing) const
+{
+    return m_gpuTimer.GetLastFrameTiming(timing);
 }
@@ -1,5 +1,7 @@
 #pragma once
 #include "IRenderer.h"
+#include "OpenGLGpuTimer.h"
+#include "GeometryBatcher.h"
 #include <windows.h>
 #include <gl/GL.h>
 #include <gl/GLU.h>
@@ -9,6 +11,7 @@
 #include <sstream>
 #include <iostream>
 #include <algorithm>
+#include <unordered_map>
 
 // OpenGL渲染器类
 class OpenGLRenderer : public IRenderer
@@ -50,8 +53,30 @@ public:
     
     // 设置渲染表面
     void SetSurface(unsigned int width, unsigned int height);
+    
+    // 设置后续几何形状的绘制颜色
+    void SetDrawColor(float r, float g, float b, float a = 1.0f);
+    
+    // GPU计时：在帧内包裹命名范围，结果在若干帧之后可读
+    void BeginGpuScope(const char* name);
+    void EndGpuScope();
+    bool GetLastGpuFrameTiming(GpuFrameTiming& timing) const;
 
 private:
+    // 单个圆形实例（中心、半径和颜色），作为实例属性上传
+    struct CircleInstance
+    {
+        float centerX, centerY, radius;
+        float color[4];
+    };
+    
+    // 按分段数缓存的单位圆网格（三角形扇，圆心 + segments + 1 个边缘点）
+    struct UnitCircleMesh
+    {
+        std::vector<float> vertices;
+        unsigned int vbo;
+    };
+
     HWND m_hwnd;
     HDC m_hdc;
     HGLRC m_hglrc;
@@ -62,6 +87,36 @@ private:
     float m_rotation;
     float m_scale;
     
+    // 当前绘制颜色和着色器
+    float m_drawColor[4];
+    unsigned int m_currentShader;
+    
+    // 当前渲染表面尺寸
+    unsigned int m_surfaceWidth, m_surfaceHeight;
+    
+    // 实例化圆形绘制
+    std::unordered_map<int, UnitCircleMesh> m_unitCircleMeshes;
+    std::vector<CircleInstance> m_circleInstances;
+    int m_circleBatchSegments;
+    unsigned int m_circleVao;
+    unsigned int m_circleInstanceVbo;
+    size_t m_circleInstanceCapacity;
+    unsigned int m_circleProgram;
+    int m_circleViewportLocation;
+    
+    // 四边形、三角形（以及无实例化路径时的圆形）的几何批处理
+    GeometryBatcher m_batcher;
+    
+    // GPU计时查询
+    OpenGLGpuTimer m_gpuTimer;
+    
     // Helper methods
     std::string ReadShaderFile(const std::string& filePath);
+    unsigned int CompileShaderProgram(const char* vertexSource, const char* fragmentSource);
+    bool CreateCircleResources();
+    void DestroyCircleResources();
+    UnitCircleMesh& GetUnitCircleMesh(int segments);
+    void FlushCircleBatch();
+    void FlushGeometryBatch();
+    void BindTexture(unsigned int textureId);
 };
\ No newline at end of file
@@ -0,0 +1,17 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+layout(location = 0) in vec4 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+layout(location = 2) flat in uint fragTextureIndex;
+
+// Bindless texture array, element 0 is plain white
+layout(set = 0, binding = 0) uniform sampler2D textures[];
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+    // One draw can mix textures, so the index is not uniform across the draw
+    outColor = fragColor * texture(textures[nonuniformEXT(fragTextureIndex)], fragTexCoord);
+}
@@ -0,0 +1,39 @@
+#version 450
+
+// One instance per sprite; the six quad corners come from gl_VertexIndex
+layout(push_constant) uniform ViewConstants {
+    mat4 view;  // sprite pixel coordinates to clip space
+} constants;
+
+layout(location = 0) in vec2 inCenter;
+layout(location = 1) in vec2 inSize;
+layout(location = 2) in vec4 inUvRect;
+layout(location = 3) in vec4 inColor;
+layout(location = 4) in float inRotation;
+layout(location = 5) in uint inTextureIndex;
+
+layout(location = 0) out vec4 fragColor;
+layout(location = 1) out vec2 fragTexCoord;
+layout(location = 2) flat out uint fragTextureIndex;
+
+const vec2 corners[6] = vec2[](
+    vec2(0.0, 0.0), vec2(1.0, 0.0), vec2(1.0, 1.0),
+    vec2(0.0, 0.0), vec2(1.0, 1.0), vec2(0.0, 1.0)
+);
+
+void main()
+{
+    vec2 corner = corners[gl_VertexIndex];
+    vec2 local = (corner - 0.5) * inSize;
+
+    // Degrees, same direction as SetTransform
+    float angle = radians(inRotation);
+    float cosAngle = cos(angle);
+    float sinAngle = sin(angle);
+    vec2 rotated = vec2(local.x * cosAngle - local.y * sinAngle, local.x * sinAngle + local.y * cosAngle);
+
+    gl_Position = constants.view * vec4(inCenter + rotated, 0.0, 1.0);
+    fragColor = inColor;
+    fragTexCoord = mix(inUvRect.xy, inUvRect.zw, corner);
+    fragTextureIndex = inTextureIndex;
+}
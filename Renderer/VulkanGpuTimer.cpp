@@ -0,0 +1,192 @@
+#include "VulkanGpuTimer.h"
+
+VulkanGpuTimer::VulkanGpuTimer()
+    : device(VK_NULL_HANDLE), available(false), timestampPeriod(1.0), timestampMask(~0ull),
+      currentSlot(nullptr), frameCounter(0), droppedFrames(0), hasLastTiming(false)
+{
+    lastTiming.frameIndex = 0;
+    lastTiming.gpuMilliseconds = 0.0;
+    lastTiming.cpuMilliseconds = 0.0;
+}
+
+VulkanGpuTimer::~VulkanGpuTimer()
+{
+    Cleanup();
+}
+
+bool VulkanGpuTimer::Initialize(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamily,
+                                uint32_t frameSlots)
+{
+    device = logicalDevice;
+    available = false;
+
+    // Queues that do not support timestamps report zero valid bits
+    uint32_t queueFamilyCount = 0;
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, nullptr);
+    std::vector<VkQueueFamilyProperties> queueFamilies(queueFamilyCount);
+    vkGetPhysicalDeviceQueueFamilyProperties(physicalDevice, &queueFamilyCount, queueFamilies.data());
+    if (queueFamily >= queueFamilyCount || queueFamilies[queueFamily].timestampValidBits == 0) {
+        return false;
+    }
+    uint32_t validBits = queueFamilies[queueFamily].timestampValidBits;
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    timestampPeriod = properties.limits.timestampPeriod;
+
+    VkQueryPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    poolInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+    poolInfo.queryCount = kMaxScopesPerFrame * 2;
+
+    frames.resize(frameSlots);
+    for (FrameSlot& slot : frames) {
+        slot.queryPool = VK_NULL_HANDLE;
+        slot.frameIndex = 0;
+        slot.pending = false;
+        slot.cpuMilliseconds = 0.0;
+        slot.scopeNames.assign(kMaxScopesPerFrame, std::string());
+        slot.scopeCount = 0;
+        if (vkCreateQueryPool(device, &poolInfo, nullptr, &slot.queryPool) != VK_SUCCESS) {
+            Cleanup();
+            return false;
+        }
+    }
+
+    frameCounter = 0;
+    droppedFrames = 0;
+    hasLastTiming = false;
+    available = true;
+    return true;
+}
+
+void VulkanGpuTimer::Cleanup()
+{
+    for (FrameSlot& slot : frames) {
+        if (slot.queryPool != VK_NULL_HANDLE) {
+            vkDestroyQueryPool(device, slot.queryPool, nullptr);
+        }
+    }
+    frames.clear();
+    openScopes.clear();
+    currentSlot = nullptr;
+    available = false;
+}
+
+void VulkanGpuTimer::BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameSlot)
+{
+    if (!available || frameSlot >= frames.size()) {
+        return;
+    }
+
+    FrameSlot& slot = frames[frameSlot];
+    if (slot.pending) {
+        Resolve(slot);
+    }
+
+    // Queries must be reset before they are written again, and resets cannot happen inside a render pass
+    vkCmdResetQueryPool(commandBuffer, slot.queryPool, 0, kMaxScopesPerFrame * 2);
+    slot.frameIndex = frameCounter;
+    slot.scopeCount = 0;
+    slot.cpuMilliseconds = 0.0;
+    currentSlot = &slot;
+    openScopes.clear();
+    frameStart = std::chrono::steady_clock::now();
+
+    BeginScope(commandBuffer, "Frame");
+}
+
+void VulkanGpuTimer::EndFrame(VkCommandBuffer commandBuffer)
+{
+    if (!available || !currentSlot) {
+        return;
+    }
+
+    // Close any scope the caller left open, including the frame scope
+    while (!openScopes.empty()) {
+        EndScope(commandBuffer);
+    }
+
+    currentSlot->cpuMilliseconds = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - frameStart).count();
+    currentSlot->pending = true;
+    currentSlot = nullptr;
+    frameCounter++;
+}
+
+void VulkanGpuTimer::BeginScope(VkCommandBuffer commandBuffer, const char* name)
+{
+    if (!available || !currentSlot) {
+        return;
+    }
+
+    if (currentSlot->scopeCount == kMaxScopesPerFrame) {
+        openScopes.push_back(-1);
+        return;
+    }
+
+    uint32_t scope = currentSlot->scopeCount++;
+    currentSlot->scopeNames[scope] = name;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, currentSlot->queryPool, scope * 2);
+    openScopes.push_back((int32_t)scope);
+}
+
+void VulkanGpuTimer::EndScope(VkCommandBuffer commandBuffer)
+{
+    if (!available || !currentSlot || openScopes.empty()) {
+        return;
+    }
+
+    int32_t scope = openScopes.back();
+    openScopes.pop_back();
+    if (scope >= 0) {
+        vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, currentSlot->queryPool,
+                            (uint32_t)scope * 2 + 1);
+    }
+}
+
+bool VulkanGpuTimer::GetLastFrameTiming(GpuFrameTiming& timing) const
+{
+    if (!hasLastTiming) {
+        return false;
+    }
+
+    timing = lastTiming;
+    return true;
+}
+
+void VulkanGpuTimer::Resolve(FrameSlot& slot)
+{
+    slot.pending = false;
+    if (slot.scopeCount == 0) {
+        return;
+    }
+
+    // No WAIT flag: the slot's fence has signaled, so anything not ready was never submitted
+    std::vector<uint64_t> timestamps(slot.scopeCount * 2);
+    VkResult result = vkGetQueryPoolResults(device, slot.queryPool, 0, slot.scopeCount * 2,
+                                            timestamps.size() * sizeof(uint64_t), timestamps.data(),
+                                            sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
+    if (result != VK_SUCCESS) {
+        droppedFrames++;
+        return;
+    }
+
+    lastTiming.frameIndex = slot.frameIndex;
+    lastTiming.cpuMilliseconds = slot.cpuMilliseconds;
+    lastTiming.gpuMilliseconds = 0.0;
+    lastTiming.scopes.clear();
+
+    for (uint32_t i = 0; i < slot.scopeCount; i++) {
+        uint64_t ticks = (timestamps[i * 2 + 1] - timestamps[i * 2]) & timestampMask;
+        double milliseconds = ticks * timestampPeriod / 1000000.0;
+        if (i == 0) {
+            lastTiming.gpuMilliseconds = milliseconds;
+        } else {
+            lastTiming.scopes.push_back({slot.scopeNames[i], milliseconds});
+        }
+    }
+
+    hasLastTiming = true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+#include "GpuTiming.h"
+#include <vulkan/vulkan.h>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Non-blocking GPU timer built on timestamp query pools, one pool per frame in flight.
+// A slot's results are read back when the slot is reused, after its fence has signaled,
+// so the CPU never waits on a query.
+class VulkanGpuTimer {
+public:
+    static const uint32_t kMaxScopesPerFrame = 128;
+
+    VulkanGpuTimer();
+    ~VulkanGpuTimer();
+
+    // queueFamily is the family the timed command buffers are submitted to
+    bool Initialize(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, uint32_t queueFamily, uint32_t frameSlots);
+    void Cleanup();
+    bool IsAvailable() const { return available; }
+
+    // Call outside a render pass, after the fence of frameSlot has signaled.
+    // Opens a scope named "Frame" that EndFrame closes.
+    void BeginFrame(VkCommandBuffer commandBuffer, uint32_t frameSlot);
+    void EndFrame(VkCommandBuffer commandBuffer);
+
+    // Named scopes inside the frame; they may nest
+    void BeginScope(VkCommandBuffer commandBuffer, const char* name);
+    void EndScope(VkCommandBuffer commandBuffer);
+
+    // Most recent frame whose results have been read back
+    bool GetLastFrameTiming(GpuFrameTiming& timing) const;
+
+    // Frames whose results were not available when their slot was reused
+    uint64_t GetDroppedFrameCount() const { return droppedFrames; }
+
+private:
+    struct FrameSlot {
+        VkQueryPool queryPool;        // scope i writes queries 2i (begin) and 2i + 1 (end)
+        uint64_t frameIndex;
+        bool pending;
+        double cpuMilliseconds;
+        std::vector<std::string> scopeNames;
+        uint32_t scopeCount;
+    };
+
+    void Resolve(FrameSlot& slot);
+
+    VkDevice device;
+    bool available;
+    double timestampPeriod;           // nanoseconds per tick
+    uint64_t timestampMask;           // valid bits of the queue's timestamps
+    std::vector<FrameSlot> frames;
+    FrameSlot* currentSlot;
+    std::vector<int32_t> openScopes;  // -1 for scopes dropped because the pool was full
+    uint64_t frameCounter;
+    uint64_t droppedFrames;
+    std::chrono::steady_clock::time_point frameStart;
+
+    bool hasLastTiming;
+    GpuFrameTiming lastTiming;
+};
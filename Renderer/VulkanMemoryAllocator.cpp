@@ -0,0 +1,337 @@
+#include "VulkanMemoryAllocator.h"
+#include <algorithm>
+#include <iostream>
+
+VulkanMemoryAllocator::VulkanMemoryAllocator()
+    : device(VK_NULL_HANDLE), memoryProperties{}, bufferImageGranularity(1),
+      blockSize(kDefaultBlockSize), maxOrder(0), maxAllocationCount(0),
+      deviceMemoryCount(0), dedicatedCount(0), allocationCount(0),
+      dedicatedBytes(0), requestedBytes(0), allocatedBytes(0)
+{
+}
+
+VulkanMemoryAllocator::~VulkanMemoryAllocator()
+{
+    Cleanup();
+}
+
+void VulkanMemoryAllocator::Initialize(VkPhysicalDevice physicalDevice, VkDevice logicalDevice, VkDeviceSize requestedBlockSize)
+{
+    device = logicalDevice;
+    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memoryProperties);
+
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    bufferImageGranularity = std::max<VkDeviceSize>(properties.limits.bufferImageGranularity, 1);
+    maxAllocationCount = properties.limits.maxMemoryAllocationCount;
+
+    // Buddy ranges are powers of two, so the block size is rounded up to one
+    maxOrder = 0;
+    while ((kMinAllocationSize << maxOrder) < requestedBlockSize) {
+        maxOrder++;
+    }
+    blockSize = kMinAllocationSize << maxOrder;
+}
+
+void VulkanMemoryAllocator::Cleanup()
+{
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (allocationCount > 0) {
+        std::cerr << "VulkanMemoryAllocator: " << allocationCount << " allocations still live at cleanup" << std::endl;
+    }
+
+    // Freeing device memory also unmaps it
+    for (auto& pool : pools) {
+        for (auto& block : pool.blocks) {
+            if (block.memory != VK_NULL_HANDLE) {
+                vkFreeMemory(device, block.memory, nullptr);
+            }
+        }
+    }
+    pools.clear();
+
+    deviceMemoryCount = 0;
+    dedicatedCount = 0;
+    allocationCount = 0;
+    dedicatedBytes = 0;
+    requestedBytes = 0;
+    allocatedBytes = 0;
+    device = VK_NULL_HANDLE;
+}
+
+bool VulkanMemoryAllocator::Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                                     VulkanResourceKind kind, VulkanAllocation& allocation, bool forceDedicated)
+{
+    uint32_t memoryType = FindMemoryType(requirements.memoryTypeBits, properties);
+    if (memoryType == UINT32_MAX) {
+        std::cerr << "VulkanMemoryAllocator: no suitable memory type" << std::endl;
+        return false;
+    }
+
+    if (forceDedicated || requirements.size > blockSize / 2) {
+        return AllocateDedicated(requirements.size, memoryType, allocation);
+    }
+
+    // Buddy ranges are aligned to their own size, so rounding up to the alignment satisfies it.
+    // When bufferImageGranularity is no larger than the smallest range, every range covers whole
+    // granularity pages and linear and optimal resources can share blocks; otherwise keep them apart.
+    VkDeviceSize granularity = bufferImageGranularity <= kMinAllocationSize ? 1 : bufferImageGranularity;
+    uint32_t order = OrderForSize(std::max(requirements.size, requirements.alignment));
+    if (order > maxOrder) {
+        return AllocateDedicated(requirements.size, memoryType, allocation);
+    }
+    VulkanResourceKind poolKind = granularity > 1 ? kind : VulkanResourceKind::Linear;
+
+    uint32_t poolIndex = 0;
+    while (poolIndex < pools.size() &&
+           (pools[poolIndex].memoryType != memoryType || pools[poolIndex].kind != poolKind)) {
+        poolIndex++;
+    }
+    if (poolIndex == pools.size()) {
+        Pool pool;
+        pool.memoryType = memoryType;
+        pool.kind = poolKind;
+        pools.push_back(pool);
+    }
+    Pool& pool = pools[poolIndex];
+
+    VkDeviceSize offset = 0;
+    uint32_t blockIndex = 0;
+    while (blockIndex < pool.blocks.size() &&
+           (pool.blocks[blockIndex].memory == VK_NULL_HANDLE ||
+            !AllocateFromBlock(pool.blocks[blockIndex], order, offset))) {
+        blockIndex++;
+    }
+    if (blockIndex == pool.blocks.size()) {
+        if (!CreateBlock(pool, blockIndex) || !AllocateFromBlock(pool.blocks[blockIndex], order, offset)) {
+            return false;
+        }
+    }
+
+    Block& block = pool.blocks[blockIndex];
+    VkDeviceSize rangeSize = kMinAllocationSize << order;
+    block.usedBytes += rangeSize;
+
+    allocation.memory = block.memory;
+    allocation.offset = offset;
+    allocation.size = requirements.size;
+    allocation.mapped = block.mapped ? static_cast<char*>(block.mapped) + offset : nullptr;
+    allocation.poolIndex = poolIndex;
+    allocation.blockIndex = blockIndex;
+    allocation.order = order;
+    allocation.dedicated = false;
+
+    allocationCount++;
+    requestedBytes += requirements.size;
+    allocatedBytes += rangeSize;
+    return true;
+}
+
+void VulkanMemoryAllocator::Free(VulkanAllocation& allocation)
+{
+    if (allocation.memory == VK_NULL_HANDLE || device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    if (allocation.dedicated) {
+        vkFreeMemory(device, allocation.memory, nullptr);
+        deviceMemoryCount--;
+        dedicatedCount--;
+        dedicatedBytes -= allocation.size;
+    } else {
+        Pool& pool = pools[allocation.poolIndex];
+        Block& block = pool.blocks[allocation.blockIndex];
+
+        // Merge with the buddy for as long as it is free too
+        VkDeviceSize offset = allocation.offset;
+        uint32_t order = allocation.order;
+        while (order < maxOrder) {
+            VkDeviceSize buddy = offset ^ (kMinAllocationSize << order);
+            auto it = block.freeLists[order].find(buddy);
+            if (it == block.freeLists[order].end()) {
+                break;
+            }
+            block.freeLists[order].erase(it);
+            offset = std::min(offset, buddy);
+            order++;
+        }
+        block.freeLists[order].insert(offset);
+
+        VkDeviceSize rangeSize = kMinAllocationSize << allocation.order;
+        block.usedBytes -= rangeSize;
+        requestedBytes -= allocation.size;
+        allocatedBytes -= rangeSize;
+
+        // Return empty blocks to the driver, but keep one per pool to avoid thrashing
+        if (block.usedBytes == 0) {
+            size_t liveBlocks = std::count_if(pool.blocks.begin(), pool.blocks.end(),
+                                              [](const Block& b) { return b.memory != VK_NULL_HANDLE; });
+            if (liveBlocks > 1) {
+                vkFreeMemory(device, block.memory, nullptr);
+                block.memory = VK_NULL_HANDLE;
+                block.mapped = nullptr;
+                block.freeLists.clear();
+                deviceMemoryCount--;
+            }
+        }
+    }
+
+    allocationCount--;
+    allocation = VulkanAllocation();
+}
+
+VulkanAllocatorStats VulkanMemoryAllocator::GetStats() const
+{
+    VulkanAllocatorStats stats;
+    stats.deviceMemoryCount = deviceMemoryCount;
+    stats.maxDeviceMemoryCount = maxAllocationCount;
+    stats.dedicatedCount = dedicatedCount;
+    stats.allocationCount = allocationCount;
+    stats.requestedBytes = requestedBytes + dedicatedBytes;
+    stats.allocatedBytes = allocatedBytes + dedicatedBytes;
+    stats.reservedBytes = dedicatedBytes;
+
+    for (const auto& pool : pools) {
+        for (const auto& block : pool.blocks) {
+            if (block.memory == VK_NULL_HANDLE) {
+                continue;
+            }
+            stats.blockCount++;
+            stats.reservedBytes += blockSize;
+            stats.freeBytes += blockSize - block.usedBytes;
+            for (uint32_t order = maxOrder + 1; order-- > 0;) {
+                if (!block.freeLists[order].empty()) {
+                    stats.largestFreeRange = std::max(stats.largestFreeRange, kMinAllocationSize << order);
+                    break;
+                }
+            }
+        }
+    }
+
+    if (stats.allocatedBytes > 0) {
+        stats.internalFragmentation = 1.0 - (double)stats.requestedBytes / (double)stats.allocatedBytes;
+    }
+    if (stats.freeBytes > 0) {
+        stats.externalFragmentation = 1.0 - (double)stats.largestFreeRange / (double)stats.freeBytes;
+    }
+    return stats;
+}
+
+uint32_t VulkanMemoryAllocator::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const
+{
+    for (uint32_t i = 0; i < memoryProperties.memoryTypeCount; i++) {
+        if ((typeFilter & (1u << i)) && (memoryProperties.memoryTypes[i].propertyFlags & properties) == properties) {
+            return i;
+        }
+    }
+    return UINT32_MAX;
+}
+
+uint32_t VulkanMemoryAllocator::OrderForSize(VkDeviceSize size) const
+{
+    uint32_t order = 0;
+    while ((kMinAllocationSize << order) < size) {
+        order++;
+    }
+    return order;
+}
+
+bool VulkanMemoryAllocator::AllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset)
+{
+    // Smallest free range that fits, then split it down to the requested order
+    uint32_t current = order;
+    while (current <= maxOrder && block.freeLists[current].empty()) {
+        current++;
+    }
+    if (current > maxOrder) {
+        return false;
+    }
+
+    auto first = block.freeLists[current].begin();
+    offset = *first;
+    block.freeLists[current].erase(first);
+
+    while (current > order) {
+        current--;
+        block.freeLists[current].insert(offset + (kMinAllocationSize << current));
+    }
+    return true;
+}
+
+bool VulkanMemoryAllocator::CreateBlock(Pool& pool, uint32_t& blockIndex)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = blockSize;
+    allocInfo.memoryTypeIndex = pool.memoryType;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        std::cerr << "VulkanMemoryAllocator: failed to allocate a " << blockSize << " byte block" << std::endl;
+        return false;
+    }
+    deviceMemoryCount++;
+
+    Block block;
+    block.memory = memory;
+    block.mapped = MapIfHostVisible(memory, pool.memoryType);
+    block.usedBytes = 0;
+    block.freeLists.resize(maxOrder + 1);
+    block.freeLists[maxOrder].insert(0);
+
+    // Reuse a slot of a block that was returned to the driver
+    for (blockIndex = 0; blockIndex < pool.blocks.size(); blockIndex++) {
+        if (pool.blocks[blockIndex].memory == VK_NULL_HANDLE) {
+            pool.blocks[blockIndex] = std::move(block);
+            return true;
+        }
+    }
+    pool.blocks.push_back(std::move(block));
+    return true;
+}
+
+bool VulkanMemoryAllocator::AllocateDedicated(VkDeviceSize size, uint32_t memoryType, VulkanAllocation& allocation)
+{
+    VkMemoryAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = size;
+    allocInfo.memoryTypeIndex = memoryType;
+
+    VkDeviceMemory memory;
+    if (vkAllocateMemory(device, &allocInfo, nullptr, &memory) != VK_SUCCESS) {
+        std::cerr << "VulkanMemoryAllocator: failed to allocate " << size << " bytes of dedicated memory" << std::endl;
+        return false;
+    }
+
+    allocation.memory = memory;
+    allocation.offset = 0;
+    allocation.size = size;
+    allocation.mapped = MapIfHostVisible(memory, memoryType);
+    allocation.poolIndex = 0;
+    allocation.blockIndex = 0;
+    allocation.order = 0;
+    allocation.dedicated = true;
+
+    deviceMemoryCount++;
+    dedicatedCount++;
+    allocationCount++;
+    dedicatedBytes += size;
+    return true;
+}
+
+void* VulkanMemoryAllocator::MapIfHostVisible(VkDeviceMemory memory, uint32_t memoryType)
+{
+    if (!(memoryProperties.memoryTypes[memoryType].propertyFlags & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) {
+        return nullptr;
+    }
+
+    // A VkDeviceMemory can only be mapped once, so host-visible blocks stay mapped for life
+    void* data = nullptr;
+    if (vkMapMemory(device, memory, 0, VK_WHOLE_SIZE, 0, &data) != VK_SUCCESS) {
+        return nullptr;
+    }
+    return data;
+}
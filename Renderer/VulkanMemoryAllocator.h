@@ -0,0 +1,100 @@
+#pragma once
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <set>
+#include <vector>
+
+// Whether a resource is linear (buffers, linear images) or optimally tiled (images).
+// Needed to keep the two apart within bufferImageGranularity.
+enum class VulkanResourceKind {
+    Linear,
+    Optimal
+};
+
+// A range of device memory handed out by VulkanMemoryAllocator
+struct VulkanAllocation {
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkDeviceSize offset = 0;
+    VkDeviceSize size = 0;          // size the caller asked for
+    void* mapped = nullptr;         // host pointer to offset, for host-visible memory
+    uint32_t poolIndex = 0;
+    uint32_t blockIndex = 0;
+    uint32_t order = 0;             // buddy order, the range spans kMinAllocationSize << order bytes
+    bool dedicated = false;
+};
+
+struct VulkanAllocatorStats {
+    uint32_t deviceMemoryCount = 0;     // live vkAllocateMemory objects (blocks + dedicated)
+    uint32_t maxDeviceMemoryCount = 0;  // driver limit (maxMemoryAllocationCount)
+    uint32_t blockCount = 0;
+    uint32_t dedicatedCount = 0;
+    uint32_t allocationCount = 0;       // live sub-allocations and dedicated allocations
+    VkDeviceSize reservedBytes = 0;     // bytes held in device memory objects
+    VkDeviceSize requestedBytes = 0;    // bytes callers asked for
+    VkDeviceSize allocatedBytes = 0;    // bytes handed out after rounding to buddy sizes
+    VkDeviceSize freeBytes = 0;         // unused bytes inside blocks
+    VkDeviceSize largestFreeRange = 0;
+    double internalFragmentation = 0.0; // 1 - requested / allocated
+    double externalFragmentation = 0.0; // 1 - largest free range / free bytes
+};
+
+// Sub-allocates device memory from large per-memory-type blocks with a buddy allocator,
+// so the number of vkAllocateMemory calls stays far below maxMemoryAllocationCount.
+class VulkanMemoryAllocator {
+public:
+    static const VkDeviceSize kDefaultBlockSize = 64ull * 1024 * 1024;
+    static const VkDeviceSize kMinAllocationSize = 256;
+
+    VulkanMemoryAllocator();
+    ~VulkanMemoryAllocator();
+
+    void Initialize(VkPhysicalDevice physicalDevice, VkDevice device, VkDeviceSize blockSize = kDefaultBlockSize);
+    void Cleanup();
+
+    // Allocations larger than half a block, or with forceDedicated, get their own VkDeviceMemory.
+    // Host-visible memory is persistently mapped and returned in allocation.mapped.
+    bool Allocate(const VkMemoryRequirements& requirements, VkMemoryPropertyFlags properties,
+                  VulkanResourceKind kind, VulkanAllocation& allocation, bool forceDedicated = false);
+    void Free(VulkanAllocation& allocation);
+
+    VulkanAllocatorStats GetStats() const;
+
+    // Returns UINT32_MAX when no memory type matches
+    uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties) const;
+
+private:
+    struct Block {
+        VkDeviceMemory memory;
+        void* mapped;
+        VkDeviceSize usedBytes;
+        std::vector<std::set<VkDeviceSize>> freeLists; // free range offsets, per order
+    };
+
+    struct Pool {
+        uint32_t memoryType;
+        VulkanResourceKind kind;
+        std::vector<Block> blocks;  // freed blocks keep their slot (memory == VK_NULL_HANDLE)
+    };
+
+    uint32_t OrderForSize(VkDeviceSize size) const;
+    bool AllocateFromBlock(Block& block, uint32_t order, VkDeviceSize& offset);
+    bool CreateBlock(Pool& pool, uint32_t& blockIndex);
+    bool AllocateDedicated(VkDeviceSize size, uint32_t memoryType, VulkanAllocation& allocation);
+    void* MapIfHostVisible(VkDeviceMemory memory, uint32_t memoryType);
+
+    VkDevice device;
+    VkPhysicalDeviceMemoryProperties memoryProperties;
+    VkDeviceSize bufferImageGranularity;
+    VkDeviceSize blockSize;
+    uint32_t maxOrder;
+    uint32_t maxAllocationCount;
+    std::vector<Pool> pools;
+
+    // Bookkeeping for GetStats
+    uint32_t deviceMemoryCount;
+    uint32_t dedicatedCount;
+    uint32_t allocationCount;
+    VkDeviceSize dedicatedBytes;
+    VkDeviceSize requestedBytes;
+    VkDeviceSize allocatedBytes;
+};
@@ -0,0 +1,169 @@
+#include "VulkanRenderer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+// Offscreen smoke run for the Vulkan backend, meant for Linux CI on lavapipe:
+// clears, draws a quad, reads the frame back and checks pixels, then records the same
+// layered frame with 1 to N recording threads and checks every thread count produces the same image.
+// A first pass compares a cold start (no pipeline cache file) with a warm start that loads the saved cache.
+namespace
+{
+    const uint32_t kWidth = 128;
+    const uint32_t kHeight = 128;
+
+    bool PixelNear(const std::vector<unsigned char>& pixels, uint32_t x, uint32_t y, const unsigned char expected[4])
+    {
+        const unsigned char* pixel = &pixels[((size_t)y * kWidth + x) * 4];
+        for (int i = 0; i < 4; i++) {
+            if (std::abs((int)pixel[i] - (int)expected[i]) > 2) {
+                std::printf("pixel (%u, %u) = %u %u %u %u, expected %u %u %u %u\n", x, y,
+                            pixel[0], pixel[1], pixel[2], pixel[3],
+                            expected[0], expected[1], expected[2], expected[3]);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool ReadFrame(VulkanRenderer& renderer, std::vector<unsigned char>& pixels)
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        if (!renderer.ReadbackFrame(pixels, width, height) || width != kWidth || height != kHeight) {
+            std::printf("ReadbackFrame failed\n");
+            return false;
+        }
+        return true;
+    }
+
+    bool RunClearAndQuad(VulkanRenderer& renderer)
+    {
+        renderer.SetClearColor(0.0f, 0.0f, 1.0f, 1.0f);
+        renderer.BeginFrame();
+        renderer.SetDrawColor(1.0f, 0.0f, 0.0f, 1.0f);
+        renderer.DrawQuad(32.0f, 32.0f, 64.0f, 64.0f);
+        renderer.EndFrame();
+
+        std::vector<unsigned char> pixels;
+        if (!ReadFrame(renderer, pixels)) {
+            return false;
+        }
+
+        const unsigned char blue[4] = {0, 0, 255, 255};
+        const unsigned char red[4] = {255, 0, 0, 255};
+        bool passed = PixelNear(pixels, 4, 4, blue) && PixelNear(pixels, kWidth - 4, kHeight - 4, blue) &&
+                      PixelNear(pixels, 64, 64, red) && PixelNear(pixels, 33, 94, red);
+        std::printf("clear + quad: %s\n", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    // 64 layers of small quads; each layer overdraws part of the previous one, so a wrong layer order shows up
+    void RecordLayeredFrame(VulkanRenderer& renderer, std::vector<unsigned char>& pixels, double& recordMs)
+    {
+        const uint32_t layerCount = 64;
+        renderer.SetClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+        renderer.BeginFrame();
+        renderer.RecordLayers(layerCount, [](VulkanLayerRecorder& recorder, uint32_t layer) {
+            recorder.SetDrawColor((layer % 4) / 3.0f, (layer % 8) / 7.0f, layer / 63.0f, 1.0f);
+            for (uint32_t i = 0; i < 256; i++) {
+                float x = (float)((layer * 7 + i * 13) % (kWidth - 16));
+                float y = (float)((layer * 11 + i * 5) % (kHeight - 16));
+                recorder.DrawQuad(x, y, 16.0f, 16.0f);
+            }
+        });
+        recordMs = renderer.GetRecordingStats().recordMs;
+        renderer.EndFrame();
+        ReadFrame(renderer, pixels);
+    }
+
+    bool InitializeRenderer(VulkanRenderer& renderer)
+    {
+#ifdef VULKAN_SHADER_DIR
+        renderer.SetShaderDirectory(VULKAN_SHADER_DIR);
+#endif
+        renderer.SetSurface(kWidth, kHeight);
+        return renderer.Initialize(nullptr) && renderer.IsOffscreen();
+    }
+
+    // Initialize/Cleanup twice against one cache file: the first run must start cold, the second must load
+    // what the first one saved
+    bool RunPipelineCacheStartup()
+    {
+        const char* cachePath = "VulkanOffscreenSmoke_pipeline_cache.bin";
+        std::remove(cachePath);
+
+        bool passed = true;
+        size_t savedBytes = 0;
+        std::printf("%8s %14s %14s %10s %8s\n", "start", "initialize ms", "pipelines ms", "pipelines", "loaded");
+        for (int run = 0; run < 2; run++) {
+            VulkanRenderer renderer;
+            renderer.SetPipelineCachePath(cachePath);
+            if (!InitializeRenderer(renderer)) {
+                std::printf("offscreen Vulkan initialization failed\n");
+                return false;
+            }
+            renderer.Cleanup();
+
+            VulkanPipelineCacheStats stats = renderer.GetPipelineCacheStats();
+            std::printf("%8s %14.3f %14.3f %10u %8s\n", run == 0 ? "cold" : "warm", stats.initializeMs,
+                        stats.pipelineCreateMs, stats.pipelinesCreated, stats.loadedFromDisk ? "yes" : "no");
+            if (run == 0) {
+                passed = passed && !stats.loadedFromDisk;
+                savedBytes = stats.savedBytes;
+            } else {
+                // A driver may legitimately return an empty cache, in which case there is nothing to load
+                passed = passed && (stats.loadedFromDisk || savedBytes == 0);
+            }
+        }
+
+        std::remove(cachePath);
+        std::printf("pipeline cache: %s\n", passed ? "ok" : "FAILED");
+        return passed;
+    }
+
+    bool RunRecordingThreads(VulkanRenderer& renderer)
+    {
+        unsigned int maxThreads = std::max(4u, std::thread::hardware_concurrency());
+        std::vector<unsigned char> reference;
+        bool passed = true;
+
+        std::printf("%8s %12s %8s\n", "threads", "record ms", "image");
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+            renderer.SetRecordingThreadCount(threads);
+            std::vector<unsigned char> pixels;
+            double recordMs = 0.0;
+            RecordLayeredFrame(renderer, pixels, recordMs);
+
+            bool same = true;
+            if (threads == 1) {
+                reference = pixels;
+            } else {
+                same = pixels == reference;
+            }
+            passed = passed && same && !pixels.empty();
+            std::printf("%8u %12.3f %8s\n", threads, recordMs, same ? "same" : "DIFFERS");
+        }
+        return passed;
+    }
+}
+
+int main()
+{
+    bool passed = RunPipelineCacheStartup();
+
+    VulkanRenderer renderer;
+    if (!InitializeRenderer(renderer)) {
+        std::printf("offscreen Vulkan initialization failed\n");
+        return 1;
+    }
+
+    passed = RunClearAndQuad(renderer) && passed;
+    passed = RunRecordingThreads(renderer) && passed;
+
+    renderer.Cleanup();
+    std::printf("%s\n", passed ? "PASSED" : "FAILED");
+    return passed ? 0 : 1;
+}
@@ -5,17 +5,67 @@
 #include <algorithm>
 #include <fstream>
 #include <optional>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <cstdio>
+#include <chrono>
+
+namespace {
+    const float kPi = 3.14159265359f;
+
+    void TransformVertex(VulkanVertex& vertex, float x, float y, float u, float v, const float transform[4],
+                         const float color[4], uint32_t textureIndex, VkExtent2D extent)
+    {
+        // Same order as the OpenGL backend: scale, rotate (degrees), then translate
+        float angle = transform[2] * kPi / 180.0f;
+        float cosAngle = cosf(angle);
+        float sinAngle = sinf(angle);
+        float scaledX = x * transform[3];
+        float scaledY = y * transform[3];
+        float pixelX = transform[0] + scaledX * cosAngle - scaledY * sinAngle;
+        float pixelY = transform[1] + scaledX * sinAngle + scaledY * cosAngle;
+        
+        // Pixel coordinates with a top-left origin map directly onto Vulkan's clip space
+        vertex.position[0] = pixelX / (float)extent.width * 2.0f - 1.0f;
+        vertex.position[1] = pixelY / (float)extent.height * 2.0f - 1.0f;
+        vertex.color[0] = color[0];
+        vertex.color[1] = color[1];
+        vertex.color[2] = color[2];
+        vertex.color[3] = color[3];
+        vertex.uv[0] = u;
+        vertex.uv[1] = v;
+        vertex.textureIndex = textureIndex;
+    }
+}
 
 VulkanRenderer::VulkanRenderer() 
     : instance(VK_NULL_HANDLE), physicalDevice(VK_NULL_HANDLE), logicalDevice(VK_NULL_HANDLE),
-      graphicsQueue(VK_NULL_HANDLE), presentQueue(VK_NULL_HANDLE), surface(VK_NULL_HANDLE),
+      graphicsQueue(VK_NULL_HANDLE), presentQueue(VK_NULL_HANDLE), transferQueue(VK_NULL_HANDLE),
+      graphicsQueueFamily(0), transferQueueFamily(0), surface(VK_NULL_HANDLE),
       swapchain(VK_NULL_HANDLE), swapchainImageFormat(VK_FORMAT_UNDEFINED),
-      renderPass(VK_NULL_HANDLE), pipelineLayout(VK_NULL_HANDLE), graphicsPipeline(VK_NULL_HANDLE),
-      commandPool(VK_NULL_HANDLE), currentFrame(0), windowHandle(nullptr),
-      nextTextureId(1), nextShaderId(1), surfaceWidth(800), surfaceHeight(600)
+      renderPass(VK_NULL_HANDLE), loadRenderPass(VK_NULL_HANDLE), pipelineLayout(VK_NULL_HANDLE), graphicsPipeline(VK_NULL_HANDLE),
+      spritePipeline(VK_NULL_HANDLE),
+      textureSetLayout(VK_NULL_HANDLE), textureDescriptorPool(VK_NULL_HANDLE), textureDescriptorSet(VK_NULL_HANDLE),
+      textureSampler(VK_NULL_HANDLE), textureCapacity(0), currentTextureIndex(0), pipelineCache(VK_NULL_HANDLE), commandPool(VK_NULL_HANDLE), framesInFlight(2),
+      requestedPresentMode(VulkanPresentMode::Mailbox), currentFrame(0), lastSubmittedFrame(SIZE_MAX), submittedFrames(0),
+      swapchainDirty(false), currentImageIndex(0), frameInProgress(false),
+      activePipeline(VK_NULL_HANDLE), boundPipeline(VK_NULL_HANDLE), batchPipeline(VK_NULL_HANDLE),
+      batchFirstVertex(0), batchVertexCount(0), vertexRingOverflowed(false), spriteBatchFirst(0), spriteBatchCount(0),
+      spriteRingOverflowed(false), windowHandle(nullptr),
+      offscreen(false),
+      shaderDirectory("Shaders/"), pipelineCachePath("pipeline_cache.bin"), nextTextureId(1), nextShaderId(1), activeShaderId(0),
+      pipelineCompilesInProgress(0), stoppingPipelineCompiles(false), surfaceWidth(800), surfaceHeight(600)
 {
     clearColor[0] = 0.0f; clearColor[1] = 0.0f; clearColor[2] = 0.0f; clearColor[3] = 1.0f;
     transform[0] = 0.0f; transform[1] = 0.0f; transform[2] = 0.0f; transform[3] = 1.0f;
+    drawColor[0] = 1.0f; drawColor[1] = 1.0f; drawColor[2] = 1.0f; drawColor[3] = 1.0f;
+    for (int i = 0; i < 16; i++) {
+        viewMatrix[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+    }
+    layerVertexCount.store(0);
+    layerSpriteCount.store(0);
+    layerRingOverflowed.store(false);
 }
 
 VulkanRenderer::~VulkanRenderer()
@@ -26,13 +76,16 @@ VulkanRenderer::~VulkanRenderer()
 bool VulkanRenderer::Initialize(HWND hwnd)
 {
     windowHandle = hwnd;
+    offscreen = hwnd == nullptr;
+    auto initializeStart = std::chrono::steady_clock::now();
+    pipelineCacheStats = VulkanPipelineCacheStats();
     
     if (!CreateInstance()) {
         std::cerr << "Failed to create Vulkan instance" << std::endl;
         return false;
     }
     
-    if (!CreateSurface()) {
+    if (!offscreen && !CreateSurface()) {
         std::cerr << "Failed to create Vulkan surface" << std::endl;
         return false;
     }
@@ -47,7 +100,24 @@ bool VulkanRenderer::Initialize(HWND hwnd)
         return false;
     }
     
-    if (!CreateSwapchain()) {
+    memoryAllocator.Initialize(physicalDevice, logicalDevice);
+    
+    if (!stagingRing.Initialize(logicalDevice, &memoryAllocator, transferQueue, transferQueueFamily)) {
+        std::cerr << "Failed to create staging ring" << std::endl;
+        return false;
+    }
+    
+    if (!CreateTextureDescriptors()) {
+        std::cerr << "Failed to create texture descriptors" << std::endl;
+        return false;
+    }
+    
+    if (!CreatePipelineCache()) {
+        std::cerr << "Failed to create pipeline cache" << std::endl;
+        return false;
+    }
+    
+    if (offscreen ? !CreateOffscreenTargets() : !CreateSwapchain()) {
         std::cerr << "Failed to create swapchain" << std::endl;
         return false;
     }
@@ -87,14 +157,45 @@ bool VulkanRenderer::Initialize(HWND hwnd)
         return false;
     }
     
+    if (!CreateVertexRings()) {
+        std::cerr << "Failed to create vertex buffers" << std::endl;
+        return false;
+    }
+    
+    // Optional: rendering works without timestamps
+    if (!gpuTimer.Initialize(physicalDevice, logicalDevice, graphicsQueueFamily, framesInFlight)) {
+        std::cerr << "GPU timestamps not supported, GPU timing disabled" << std::endl;
+    }
+    
+    if (!CreateRecordingContexts()) {
+        std::cerr << "Failed to create recording command pools" << std::endl;
+        return false;
+    }
+    
+    activePipeline = graphicsPipeline;
+    activeShaderId = 0;
+    pipelineCacheStats.initializeMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - initializeStart).count();
+    StartPipelineCompileThreads();
     return true;
 }
 
 void VulkanRenderer::Cleanup()
 {
     if (logicalDevice != VK_NULL_HANDLE) {
+        StopPipelineCompileThreads();
         vkDeviceWaitIdle(logicalDevice);
         
+        DestroyVertexRings();
+        
+        for (auto& texturePair : textures) {
+            vkDestroyImageView(logicalDevice, texturePair.second.view, nullptr);
+            vkDestroyImage(logicalDevice, texturePair.second.image, nullptr);
+            memoryAllocator.Free(texturePair.second.allocation);
+        }
+        textures.clear();
+        DestroyTextureDescriptors();
+        
         // Clean up shader resources
         for (auto& shaderPair : vertexShaders) {
             vkDestroyShaderModule(logicalDevice, shaderPair.second, nullptr);
@@ -115,6 +216,7 @@ void VulkanRenderer::Cleanup()
             vkDestroyFence(logicalDevice, inFlightFences[i], nullptr);
         }
         
+        DestroyRecordingContexts();
         vkDestroyCommandPool(logicalDevice, commandPool, nullptr);
         
         for (auto framebuffer : swapchainFramebuffers) {
@@ -122,36 +224,127 @@ void VulkanRenderer::Cleanup()
         }
         
         vkDestroyPipeline(logicalDevice, graphicsPipeline, nullptr);
+        vkDestroyPipeline(logicalDevice, spritePipeline, nullptr);
         vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
         vkDestroyRenderPass(logicalDevice, renderPass, nullptr);
+        vkDestroyRenderPass(logicalDevice, loadRenderPass, nullptr);
         
         for (auto imageView : swapchainImageViews) {
             vkDestroyImageView(logicalDevice, imageView, nullptr);
         }
+        ReleaseRetiredSwapchains(true);
         
-        vkDestroySwapchainKHR(logicalDevice, swapchain, nullptr);
-        vkDestroySurfaceKHR(instance, surface, nullptr);
+        if (offscreen) {
+            DestroyOffscreenTargets();
+        } else {
+            vkDestroySwapchainKHR(logicalDevice, swapchain, nullptr);
+            vkDestroySurfaceKHR(instance, surface, nullptr);
+        }
+        swapchain = VK_NULL_HANDLE;
+        surface = VK_NULL_HANDLE;
+        gpuTimer.Cleanup();
+        SavePipelineCache();
+        stagingRing.Cleanup();
+        memoryAllocator.Cleanup();
         vkDestroyDevice(logicalDevice, nullptr);
         vkDestroyInstance(instance, nullptr);
+        
+        vertexShaders.clear();
+        fragmentShaders.clear();
+        shaderPipelines.clear();
+        shaderStatus.clear();
+        shaderPipelineLayouts.clear();
+        inFlightFences.clear();
+        imagesInFlight.clear();
+        imageAvailableSemaphores.clear();
+        renderFinishedSemaphores.clear();
+        swapchainFramebuffers.clear();
+        swapchainImageViews.clear();
+        swapchainImages.clear();
+        logicalDevice = VK_NULL_HANDLE;
+        physicalDevice = VK_NULL_HANDLE;
+        instance = VK_NULL_HANDLE;
+        frameInProgress = false;
+        lastSubmittedFrame = SIZE_MAX;
+        submittedFrames = 0;
+        swapchainDirty = false;
     }
 }
 
 void VulkanRenderer::BeginFrame()
 {
+    auto fenceWaitStart = std::chrono::steady_clock::now();
     vkWaitForFences(logicalDevice, 1, &inFlightFences[currentFrame], VK_TRUE, UINT64_MAX);
+    double fenceWaitMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - fenceWaitStart).count();
+    
+    if (frameInProgress) {
+        return;
+    }
+    
+    InstallCompiledPipelines();
+    ReleaseRetiredSwapchains(false);
+    
+    // A failed rebuild (e.g. a minimized window) skips the frame and is retried next time
+    if ((swapchainDirty || (!offscreen && swapchain == VK_NULL_HANDLE)) && !RecreateSwapchain()) {
+        return;
+    }
+    // A rebuild that could not finish leaves no framebuffers; draw nothing until the next resize retries it
+    if (swapchainFramebuffers.empty()) {
+        return;
+    }
     
-    uint32_t imageIndex;
-    VkResult result = vkAcquireNextImageKHR(logicalDevice, swapchain, UINT64_MAX,
-                                           imageAvailableSemaphores[currentFrame], 
+    // Offscreen targets are owned per frame slot, so the fence above already made this one free
+    uint32_t imageIndex = (uint32_t)currentFrame;
+    VkResult result = VK_SUCCESS;
+    double acquireMs = 0.0;
+    if (!offscreen) {
+        auto acquireStart = std::chrono::steady_clock::now();
+        result = vkAcquireNextImageKHR(logicalDevice, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame],
+                                       VK_NULL_HANDLE, &imageIndex);
+        if (result == VK_ERROR_OUT_OF_DATE_KHR) {
+            // Nothing was acquired, so the semaphore is still unsignaled and can be reused right away
+            if (!RecreateSwapchain()) {
+                return;
+            }
+            result = vkAcquireNextImageKHR(logicalDevice, swapchain, UINT64_MAX, imageAvailableSemaphores[currentFrame],
                                            VK_NULL_HANDLE, &imageIndex);
+        }
+        acquireMs = std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - acquireStart).count();
+    }
     
     if (result == VK_ERROR_OUT_OF_DATE_KHR) {
-        // Swapchain needs recreation
+        swapchainDirty = true;
         return;
-    } else if (result != VK_SUCCESS && result != VK_SUBOPTIMAL_KHR) {
+    } else if (result == VK_SUBOPTIMAL_KHR) {
+        // The image is acquired and its semaphore will signal, so render this frame and rebuild after it
+        swapchainDirty = true;
+    } else if (result != VK_SUCCESS) {
         throw std::runtime_error("Failed to acquire swapchain image!");
     }
     
+    // With more frames in flight than swapchain images, an image can come back while
+    // another frame slot is still rendering to it
+    if (!offscreen && imagesInFlight[imageIndex] != VK_NULL_HANDLE &&
+        imagesInFlight[imageIndex] != inFlightFences[currentFrame]) {
+        fenceWaitStart = std::chrono::steady_clock::now();
+        vkWaitForFences(logicalDevice, 1, &imagesInFlight[imageIndex], VK_TRUE, UINT64_MAX);
+        fenceWaitMs += std::chrono::duration<double, std::milli>(
+            std::chrono::steady_clock::now() - fenceWaitStart).count();
+    }
+    if (!offscreen) {
+        imagesInFlight[imageIndex] = inFlightFences[currentFrame];
+    }
+    
+    frameTimingStats.frameCount++;
+    frameTimingStats.lastFenceWaitMs = fenceWaitMs;
+    frameTimingStats.lastAcquireMs = acquireMs;
+    frameTimingStats.totalFenceWaitMs += fenceWaitMs;
+    frameTimingStats.totalAcquireMs += acquireMs;
+    frameTimingStats.maxFenceWaitMs = std::max(frameTimingStats.maxFenceWaitMs, fenceWaitMs);
+    frameTimingStats.maxAcquireMs = std::max(frameTimingStats.maxAcquireMs, acquireMs);
+    
     vkResetFences(logicalDevice, 1, &inFlightFences[currentFrame]);
     
     vkResetCommandBuffer(commandBuffers[currentFrame], 0);
@@ -165,51 +358,124 @@ void VulkanRenderer::BeginFrame()
         throw std::runtime_error("Failed to begin recording command buffer!");
     }
     
-    VkRenderPassBeginInfo renderPassInfo{};
-    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-    renderPassInfo.renderPass = renderPass;
-    renderPassInfo.framebuffer = swapchainFramebuffers[imageIndex];
-    renderPassInfo.renderArea.offset = {0, 0};
-    renderPassInfo.renderArea.extent = swapchainExtent;
-    
-    VkClearValue clearColorValue;
-    clearColorValue.color.float32[0] = this->clearColor[0];
-    clearColorValue.color.float32[1] = this->clearColor[1];
-    clearColorValue.color.float32[2] = this->clearColor[2];
-    clearColorValue.color.float32[3] = this->clearColor[3];
+    // The fence above retired this slot's previous frame, so its timestamps are ready to read
+    gpuTimer.BeginFrame(commandBuffers[currentFrame], (uint32_t)currentFrame);
     
-    renderPassInfo.clearValueCount = 1;
-    renderPassInfo.pClearValues = &clearColorValue;
+    // Secondary command buffers of this frame slot were consumed by the submission waited on above
+    for (auto& context : recordingContexts[currentFrame]) {
+        if (context.usedBuffers > 0) {
+            vkResetCommandPool(logicalDevice, context.commandPool, 0);
+            context.usedBuffers = 0;
+        }
+    }
     
-    vkCmdBeginRenderPass(commandBuffers[currentFrame], &renderPassInfo, VK_SUBPASS_CONTENTS_INLINE);
+    currentImageIndex = imageIndex;
+    vertexRings[currentFrame].vertexCount = 0;
+    spriteRings[currentFrame].spriteCount = 0;
+    UpdateSpriteView();
+    BeginRenderPassInstance(renderPass, VK_SUBPASS_CONTENTS_INLINE);
+    
+    boundPipeline = VK_NULL_HANDLE;
+    batchPipeline = VK_NULL_HANDLE;
+    batchFirstVertex = 0;
+    batchVertexCount = 0;
+    vertexRingOverflowed = false;
+    spriteBatchFirst = 0;
+    spriteBatchCount = 0;
+    spriteRingOverflowed = false;
+    
+    frameInProgress = true;
 }
 
 void VulkanRenderer::EndFrame()
 {
+    if (!frameInProgress) {
+        return;
+    }
+    
+    FlushDrawBatch();
+    frameInProgress = false;
+    
     vkCmdEndRenderPass(commandBuffers[currentFrame]);
+    gpuTimer.EndFrame(commandBuffers[currentFrame]);
+    
+    if (offscreen) {
+        // The render pass left the target in TRANSFER_SRC_OPTIMAL
+        OffscreenTarget& target = offscreenTargets[currentImageIndex];
+        VkBufferImageCopy region{};
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.layerCount = 1;
+        region.imageExtent = {swapchainExtent.width, swapchainExtent.height, 1};
+        vkCmdCopyImageToBuffer(commandBuffers[currentFrame], target.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+                               target.readbackBuffer, 1, &region);
+
+        // The fence wait in ReadbackFrame only orders execution; this makes the copied
+        // bytes available to host reads of the mapped buffer
+        VkBufferMemoryBarrier hostBarrier{};
+        hostBarrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+        hostBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+        hostBarrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+        hostBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        hostBarrier.buffer = target.readbackBuffer;
+        hostBarrier.offset = 0;
+        hostBarrier.size = VK_WHOLE_SIZE;
+        vkCmdPipelineBarrier(commandBuffers[currentFrame], VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+                             0, 0, nullptr, 1, &hostBarrier, 0, nullptr);
+    }
     
     if (vkEndCommandBuffer(commandBuffers[currentFrame]) != VK_SUCCESS) {
         throw std::runtime_error("Failed to record command buffer!");
     }
     
+    // Uploads recorded since the last frame go out in one batch. The GPU waits for them
+    // through the timeline semaphore, so the CPU never blocks on the transfer queue.
+    uint64_t uploadValue = stagingRing.Submit();
+    
     VkSubmitInfo submitInfo{};
     submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
     
-    VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrame]};
-    VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
-    submitInfo.waitSemaphoreCount = 1;
-    submitInfo.pWaitSemaphores = waitSemaphores;
-    submitInfo.pWaitDstStageMask = waitStages;
+    // Offscreen frames have no acquire to wait for and nothing to present
+    std::vector<VkSemaphore> waitSemaphores;
+    std::vector<VkPipelineStageFlags> waitStages;
+    std::vector<uint64_t> waitValues;
+    if (!offscreen) {
+        waitSemaphores.push_back(imageAvailableSemaphores[currentFrame]);
+        waitStages.push_back(VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+        waitValues.push_back(0);
+    }
+    if (uploadValue > 0) {
+        waitSemaphores.push_back(stagingRing.GetTimelineSemaphore());
+        waitStages.push_back(VK_PIPELINE_STAGE_VERTEX_INPUT_BIT | VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT);
+        waitValues.push_back(uploadValue);
+    }
+    
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.waitSemaphoreValueCount = (uint32_t)waitValues.size();
+    timelineInfo.pWaitSemaphoreValues = waitValues.data();
+    
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.waitSemaphoreCount = (uint32_t)waitSemaphores.size();
+    submitInfo.pWaitSemaphores = waitSemaphores.data();
+    submitInfo.pWaitDstStageMask = waitStages.data();
     submitInfo.commandBufferCount = 1;
     submitInfo.pCommandBuffers = &commandBuffers[currentFrame];
     
     VkSemaphore signalSemaphores[] = {renderFinishedSemaphores[currentFrame]};
-    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.signalSemaphoreCount = offscreen ? 0 : 1;
     submitInfo.pSignalSemaphores = signalSemaphores;
     
     if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, inFlightFences[currentFrame]) != VK_SUCCESS) {
         throw std::runtime_error("Failed to submit draw command buffer!");
     }
+    lastSubmittedFrame = currentFrame;
+    submittedFrames++;
+    
+    if (offscreen) {
+        currentFrame = (currentFrame + 1) % inFlightFences.size();
+        return;
+    }
     
     VkPresentInfoKHR presentInfo{};
     presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -221,13 +487,13 @@ void VulkanRenderer::EndFrame()
     presentInfo.swapchainCount = 1;
     presentInfo.pSwapchains = swapchains;
     
-    presentInfo.pImageIndices = &currentFrame;
+    presentInfo.pImageIndices = &currentImageIndex;
     presentInfo.pResults = nullptr;
     
     VkResult result = vkQueuePresentKHR(presentQueue, &presentInfo);
     
     if (result == VK_ERROR_OUT_OF_DATE_KHR || result == VK_SUBOPTIMAL_KHR) {
-        // Swapchain needs recreation - handle this in a real application
+        swapchainDirty = true;
     } else if (result != VK_SUCCESS) {
         throw std::runtime_error("Failed to present swapchain image!");
     }
@@ -245,21 +511,113 @@ void VulkanRenderer::SetClearColor(float r, float g, float b, float a)
 
 void VulkanRenderer::DrawQuad(float x, float y, float width, float height)
 {
-    // In a real implementation, this would draw a quad using Vulkan
-    // For now, we just log the call
-    std::cout << "Drawing quad at (" << x << ", " << y << ") with size (" << width << ", " << height << ")" << std::endl;
+    VulkanVertex* vertices = AllocateVertices(6);
+    if (!vertices) {
+        return;
+    }
+    
+    // Two triangles: (0, 1, 2) and (0, 2, 3)
+    WriteVertex(vertices[0], x, y, 0.0f, 0.0f);
+    WriteVertex(vertices[1], x + width, y, 1.0f, 0.0f);
+    WriteVertex(vertices[2], x + width, y + height, 1.0f, 1.0f);
+    vertices[3] = vertices[0];
+    vertices[4] = vertices[2];
+    WriteVertex(vertices[5], x, y + height, 0.0f, 1.0f);
 }
 
 void VulkanRenderer::DrawTriangle(float x1, float y1, float x2, float y2, float x3, float y3)
 {
-    // In a real implementation, this would draw a triangle using Vulkan
-    std::cout << "Drawing triangle at (" << x1 << ", " << y1 << "), (" << x2 << ", " << y2 << "), (" << x3 << ", " << y3 << ")" << std::endl;
+    VulkanVertex* vertices = AllocateVertices(3);
+    if (!vertices) {
+        return;
+    }
+    
+    WriteVertex(vertices[0], x1, y1, 0.0f, 0.0f);
+    WriteVertex(vertices[1], x2, y2, 1.0f, 0.0f);
+    WriteVertex(vertices[2], x3, y3, 0.0f, 1.0f);
 }
 
 void VulkanRenderer::DrawCircle(float centerX, float centerY, float radius, int segments)
 {
-    // In a real implementation, this would draw a circle using Vulkan
-    std::cout << "Drawing circle at (" << centerX << ", " << centerY << ") with radius " << radius << std::endl;
+    segments = std::max(segments, 3);
+    
+    VulkanVertex* vertices = AllocateVertices(static_cast<uint32_t>(segments) * 3);
+    if (!vertices) {
+        return;
+    }
+    
+    // Expand the cached unit circle into a triangle list so circles merge with other shapes
+    const std::vector<float>& unitCircle = GetUnitCircle(segments);
+    VulkanVertex center;
+    WriteVertex(center, centerX, centerY, 0.5f, 0.5f);
+    
+    for (int i = 0; i < segments; i++) {
+        vertices[i * 3] = center;
+        const float* edge = &unitCircle[i * 2];
+        WriteVertex(vertices[i * 3 + 1], centerX + edge[0] * radius, centerY + edge[1] * radius,
+                    0.5f + edge[0] * 0.5f, 0.5f + edge[1] * 0.5f);
+        WriteVertex(vertices[i * 3 + 2], centerX + edge[2] * radius, centerY + edge[3] * radius,
+                    0.5f + edge[2] * 0.5f, 0.5f + edge[3] * 0.5f);
+    }
+}
+
+void VulkanRenderer::DrawSprite(float x, float y, float width, float height, float rotation)
+{
+    VulkanSprite* sprite = AllocateSprites(1);
+    if (!sprite) {
+        return;
+    }
+    
+    sprite->position[0] = x + width * 0.5f;
+    sprite->position[1] = y + height * 0.5f;
+    sprite->size[0] = width;
+    sprite->size[1] = height;
+    sprite->uvRect[0] = 0.0f;
+    sprite->uvRect[1] = 0.0f;
+    sprite->uvRect[2] = 1.0f;
+    sprite->uvRect[3] = 1.0f;
+    for (int i = 0; i < 4; i++) {
+        sprite->color[i] = drawColor[i];
+    }
+    sprite->rotation = rotation;
+    sprite->textureId = currentTextureIndex;
+}
+
+void VulkanRenderer::DrawSpriteLayer(const VulkanSprite* sprites, uint32_t count)
+{
+    if (count == 0) {
+        return;
+    }
+    
+    VulkanSprite* instances = AllocateSprites(count);
+    if (!instances) {
+        return;
+    }
+    
+    memcpy(instances, sprites, sizeof(VulkanSprite) * count);
+    // Unknown IDs would sample an unwritten descriptor
+    for (uint32_t i = 0; i < count; i++) {
+        instances[i].textureId = GetTextureIndex(instances[i].textureId);
+    }
+    FlushSpriteBatch();
+}
+
+void VulkanRenderer::SetViewMatrix(const float* matrix)
+{
+    // Sprites already batched were drawn with the previous view
+    if (frameInProgress) {
+        FlushDrawBatch();
+    }
+    
+    for (int i = 0; i < 16; i++) {
+        viewMatrix[i] = matrix ? matrix[i] : ((i % 5 == 0) ? 1.0f : 0.0f);
+    }
+    
+    if (frameInProgress) {
+        UpdateSpriteView();
+        vkCmdPushConstants(commandBuffers[currentFrame], pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                           sizeof(VulkanViewPushConstants), &spriteView);
+    }
 }
 
 void VulkanRenderer::SetTransform(float x, float y, float rotation, float scale)
@@ -272,227 +630,440 @@ void VulkanRenderer::SetTransform(float x, float y, float rotation, float scale)
 
 unsigned int VulkanRenderer::LoadTexture(const std::string& filename)
 {
-    // In a real implementation, this would load a texture using Vulkan
-    unsigned int textureId = nextTextureId++;
-    std::cout << "Loading texture: " << filename << " with ID: " << textureId << std::endl;
+    // Same procedural stand-in as the OpenGL backend until an image loading library is added
+    std::string extension = filename.substr(filename.find_last_of(".") + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    
+    uint32_t width = 2;
+    uint32_t height = 2;
+    std::vector<unsigned char> imageData = {
+        255, 0, 0, 255,     // Red pixel
+        0, 255, 0, 255,     // Green pixel
+        0, 0, 255, 255,     // Blue pixel
+        255, 255, 0, 255    // Yellow pixel
+    };
+    if (extension == "bmp" || extension == "png" || extension == "jpg" || extension == "jpeg") {
+        width = 256;
+        height = 256;
+        imageData.resize(width * height * 4);
+        for (uint32_t y = 0; y < height; ++y) {
+            for (uint32_t x = 0; x < width; ++x) {
+                uint32_t idx = (y * width + x) * 4;
+                imageData[idx] = static_cast<unsigned char>((x * 255) / width);
+                imageData[idx + 1] = static_cast<unsigned char>((y * 255) / height);
+                imageData[idx + 2] = static_cast<unsigned char>((x + y) % 256);
+                imageData[idx + 3] = 255;
+            }
+        }
+    }
+    
+    // Texture IDs index the bindless descriptor array directly
+    unsigned int textureId = nextTextureId;
+    if (textureId >= textureCapacity) {
+        std::cerr << "Bindless texture array full, cannot load: " << filename << std::endl;
+        return 0;
+    }
+    if (!CreateTexture(imageData.data(), width, height, textureId)) {
+        std::cerr << "Failed to create texture: " << filename << std::endl;
+        return 0;
+    }
+    
+    nextTextureId++;
     return textureId;
 }
 
 void VulkanRenderer::UseTexture(unsigned int textureId)
 {
-    // In a real implementation, this would bind a texture using Vulkan
-    std::cout << "Using texture ID: " << textureId << std::endl;
+    // Only changes the index written into following vertices; batches and descriptors are untouched
+    currentTextureIndex = GetTextureIndex(textureId);
 }
 
 unsigned int VulkanRenderer::LoadShader(const std::string& vertexShaderFile, const std::string& fragmentShaderFile)
 {
-    // Read shader files
-    std::vector<char> vertShaderCode = ReadShaderFile(vertexShaderFile);
-    std::vector<char> fragShaderCode = ReadShaderFile(fragmentShaderFile);
-    
-    if (vertShaderCode.empty() || fragShaderCode.empty()) {
-        std::cerr << "Failed to read shader files" << std::endl;
-        return 0;
-    }
-    
-    // Create shader modules
-    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
-    VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
-    
-    if (vertShaderModule == VK_NULL_HANDLE || fragShaderModule == VK_NULL_HANDLE) {
-        std::cerr << "Failed to create shader modules" << std::endl;
-        return 0;
-    }
-    
-    // Create pipeline for this shader combination
-    VkPipelineLayout pipelineLayout;
-    VkPipeline graphicsPipeline;
-    
-    // Create pipeline layout
-    VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
-    pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
-    
-    if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        std::cerr << "Failed to create pipeline layout" << std::endl;
-        vkDestroyShaderModule(logicalDevice, vertShaderModule, nullptr);
-        vkDestroyShaderModule(logicalDevice, fragShaderModule, nullptr);
+    if (pipelineCompileThreads.empty()) {
+        std::cerr << "Cannot load shaders before the renderer is initialized" << std::endl;
         return 0;
     }
     
-    // Create shader stage creation info
-    VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
-    vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule;
-    vertShaderStageInfo.pName = "main";
-    
-    VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
-    fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-    fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule;
-    fragShaderStageInfo.pName = "main";
-    
-    VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
-    
-    // Vertex input state
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.pVertexBindingDescriptions = nullptr;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    vertexInputInfo.pVertexAttributeDescriptions = nullptr;
-    
-    // Input assembly
-    VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
-    inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-    inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-    inputAssembly.primitiveRestartEnable = VK_FALSE;
-    
-    // Viewport and scissor
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)swapchainExtent.width;
-    viewport.height = (float)swapchainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-    
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapchainExtent;
-    
-    VkPipelineViewportStateCreateInfo viewportState{};
-    viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-    viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
-    viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
-    
-    // Rasterizer
-    VkPipelineRasterizationStateCreateInfo rasterizer{};
-    rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-    rasterizer.depthClampEnable = VK_FALSE;
-    rasterizer.rasterizerDiscardEnable = VK_FALSE;
-    rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
-    rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
-    rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
-    rasterizer.depthBiasEnable = VK_FALSE;
-    rasterizer.depthBiasConstantFactor = 0.0f;
-    rasterizer.depthBiasClamp = 0.0f;
-    rasterizer.depthBiasSlopeFactor = 0.0f;
-    
-    // Multisampling
-    VkPipelineMultisampleStateCreateInfo multisampling{};
-    multisampling.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-    multisampling.sampleShadingEnable = VK_FALSE;
-    multisampling.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-    multisampling.minSampleShading = 1.0f;
-    multisampling.pSampleMask = nullptr;
-    multisampling.alphaToCoverageEnable = VK_FALSE;
-    multisampling.alphaToOneEnable = VK_FALSE;
-    
-    // Color blend state
-    VkPipelineColorBlendAttachmentState colorBlendAttachment{};
-    colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | 
-                                          VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
-    colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
-    colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-    colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
-    
-    VkPipelineColorBlendStateCreateInfo colorBlending{};
-    colorBlending.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-    colorBlending.logicOpEnable = VK_FALSE;
-    colorBlending.logicOp = VK_LOGIC_OP_COPY;
-    colorBlending.attachmentCount = 1;
-    colorBlending.pAttachments = &colorBlendAttachment;
-    colorBlending.blendConstants[0] = 0.0f;
-    colorBlending.blendConstants[1] = 0.0f;
-    colorBlending.blendConstants[2] = 0.0f;
-    colorBlending.blendConstants[3] = 0.0f;
-    
-    // Graphics pipeline creation
-    VkGraphicsPipelineCreateInfo pipelineInfo{};
-    pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-    pipelineInfo.stageCount = 2;
-    pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
-    pipelineInfo.pInputAssemblyState = &inputAssembly;
-    pipelineInfo.pViewportState = &viewportState;
-    pipelineInfo.pRasterizationState = &rasterizer;
-    pipelineInfo.pMultisampleState = &multisampling;
-    pipelineInfo.pDepthStencilState = nullptr;
-    pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = nullptr;
-    pipelineInfo.layout = pipelineLayout;
-    pipelineInfo.renderPass = renderPass;
-    pipelineInfo.subpass = 0;
-    pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
-    pipelineInfo.basePipelineIndex = -1;
-    
-    if (vkCreateGraphicsPipelines(logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        std::cerr << "Failed to create graphics pipeline for shader" << std::endl;
-        vkDestroyShaderModule(logicalDevice, vertShaderModule, nullptr);
-        vkDestroyShaderModule(logicalDevice, fragShaderModule, nullptr);
-        vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
-        return 0;
+    // Reading, module and pipeline creation all happen on a compile thread, so loading
+    // materials mid-level does not stall the frame
+    PipelineCompileJob job;
+    job.shaderId = nextShaderId++;
+    job.vertexShaderFile = vertexShaderFile;
+    job.fragmentShaderFile = fragmentShaderFile;
+    shaderStatus[job.shaderId] = VulkanShaderStatus::Compiling;
+    
+    {
+        std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+        queuedPipelineCompiles.push_back(job);
+        pipelineCompilesInProgress++;
     }
+    pipelineCompileAvailable.notify_one();
     
-    // Store the shader modules and pipeline
-    unsigned int shaderId = nextShaderId++;
-    vertexShaders[shaderId] = vertShaderModule;
-    fragmentShaders[shaderId] = fragShaderModule;
-    shaderPipelines[shaderId] = graphicsPipeline;
-    shaderPipelineLayouts[shaderId] = pipelineLayout;
-    
-    std::cout << "Loaded shader from " << vertexShaderFile << " and " << fragmentShaderFile << " with ID: " << shaderId << std::endl;
-    return shaderId;
+    return job.shaderId;
 }
 
 void VulkanRenderer::UseShader(unsigned int shaderId)
 {
-    // In a real implementation, this would bind the shader pipeline
-    std::cout << "Using shader ID: " << shaderId << std::endl;
-    // For now, we just log the call - in a real implementation, we would bind the pipeline
+    // The pipeline is bound lazily when the next shape is recorded, so switching
+    // back and forth without drawing costs nothing. Shaders still compiling draw
+    // with the built-in pipeline and switch over once installed.
+    activeShaderId = shaderId;
+    auto it = shaderPipelines.find(shaderId);
+    activePipeline = it != shaderPipelines.end() ? it->second : graphicsPipeline;
 }
 
-void VulkanRenderer::SetSurface(unsigned int width, unsigned int height)
+void VulkanRenderer::BeginGpuScope(const char* name)
 {
-    surfaceWidth = width;
-    surfaceHeight = height;
-    std::cout << "Surface set to " << width << "x" << height << std::endl;
-    // In a real implementation, this might involve recreating swapchain or adjusting viewport
+    if (!frameInProgress) {
+        return;
+    }
+    // Pending shapes belong to whatever scope was open when they were drawn
+    FlushDrawBatch();
+    gpuTimer.BeginScope(commandBuffers[currentFrame], name);
 }
 
-// Helper methods implementation
-bool VulkanRenderer::CreateInstance()
+void VulkanRenderer::EndGpuScope()
 {
-    VkApplicationInfo appInfo{};
-    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
-    appInfo.pApplicationName = "Game Engine";
-    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.pEngineName = "No Engine";
-    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
-    appInfo.apiVersion = VK_API_VERSION_1_0;
+    if (!frameInProgress) {
+        return;
+    }
+    FlushDrawBatch();
+    gpuTimer.EndScope(commandBuffers[currentFrame]);
+}
 
-    uint32_t extensionCount = 0;
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
-    std::vector<VkExtensionProperties> extensions(extensionCount);
-    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+bool VulkanRenderer::GetLastGpuFrameTiming(GpuFrameTiming& timing) const
+{
+    return gpuTimer.GetLastFrameTiming(timing);
+}
 
-    VkInstanceCreateInfo createInfo{};
-    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+VulkanShaderStatus VulkanRenderer::GetShaderStatus(unsigned int shaderId)
+{
+    InstallCompiledPipelines();
+    auto it = shaderStatus.find(shaderId);
+    return it != shaderStatus.end() ? it->second : VulkanShaderStatus::Unknown;
+}
+
+void VulkanRenderer::WaitForShaders()
+{
+    {
+        std::unique_lock<std::mutex> lock(pipelineCompileMutex);
+        pipelineCompileFinished.wait(lock, [this] { return pipelineCompilesInProgress == 0; });
+    }
+    InstallCompiledPipelines();
+}
+
+void VulkanRenderer::StartPipelineCompileThreads()
+{
+    // Leave most cores to the game; pipeline creation is long but rare
+    unsigned int threadCount = std::max(1u, std::min(4u, std::thread::hardware_concurrency() / 2));
+    stoppingPipelineCompiles = false;
+    for (unsigned int i = 0; i < threadCount; i++) {
+        pipelineCompileThreads.emplace_back(&VulkanRenderer::PipelineCompileLoop, this);
+    }
+}
+
+void VulkanRenderer::StopPipelineCompileThreads()
+{
+    {
+        std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+        stoppingPipelineCompiles = true;
+        pipelineCompilesInProgress -= (unsigned int)queuedPipelineCompiles.size();
+        queuedPipelineCompiles.clear();
+    }
+    pipelineCompileAvailable.notify_all();
+    
+    for (auto& thread : pipelineCompileThreads) {
+        thread.join();
+    }
+    pipelineCompileThreads.clear();
+    
+    // Hand pipelines that finished after the last BeginFrame to the maps Cleanup destroys
+    InstallCompiledPipelines();
+}
+
+void VulkanRenderer::PipelineCompileLoop()
+{
+    for (;;) {
+        PipelineCompileJob job;
+        {
+            std::unique_lock<std::mutex> lock(pipelineCompileMutex);
+            pipelineCompileAvailable.wait(lock, [this] {
+                return stoppingPipelineCompiles || !queuedPipelineCompiles.empty();
+            });
+            if (stoppingPipelineCompiles) {
+                return;
+            }
+            job = queuedPipelineCompiles.front();
+            queuedPipelineCompiles.pop_front();
+        }
+        
+        if (!CompileShaderPipeline(job)) {
+            std::cerr << "Failed to compile pipeline for " << job.vertexShaderFile << " and "
+                      << job.fragmentShaderFile << std::endl;
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+            finishedPipelineCompiles.push_back(job);
+            pipelineCompilesInProgress--;
+        }
+        pipelineCompileFinished.notify_all();
+    }
+}
+
+bool VulkanRenderer::CompileShaderPipeline(PipelineCompileJob& job)
+{
+    std::vector<char> vertShaderCode = ReadShaderFile(job.vertexShaderFile);
+    std::vector<char> fragShaderCode = ReadShaderFile(job.fragmentShaderFile);
+    if (vertShaderCode.empty() || fragShaderCode.empty()) {
+        return false;
+    }
+    
+    job.vertShaderModule = CreateShaderModule(vertShaderCode);
+    job.fragShaderModule = CreateShaderModule(fragShaderCode);
+    
+    bool success = job.vertShaderModule != VK_NULL_HANDLE && job.fragShaderModule != VK_NULL_HANDLE &&
+                   CreatePipelineLayout(job.layout) &&
+                   CreatePipeline(job.vertShaderModule, job.fragShaderModule, job.layout, job.pipeline);
+    if (success) {
+        return true;
+    }
+    
+    if (job.vertShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(logicalDevice, job.vertShaderModule, nullptr);
+        job.vertShaderModule = VK_NULL_HANDLE;
+    }
+    if (job.fragShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(logicalDevice, job.fragShaderModule, nullptr);
+        job.fragShaderModule = VK_NULL_HANDLE;
+    }
+    if (job.layout != VK_NULL_HANDLE) {
+        vkDestroyPipelineLayout(logicalDevice, job.layout, nullptr);
+        job.layout = VK_NULL_HANDLE;
+    }
+    job.pipeline = VK_NULL_HANDLE;
+    return false;
+}
+
+void VulkanRenderer::InstallCompiledPipelines()
+{
+    std::vector<PipelineCompileJob> finished;
+    {
+        std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+        finished.swap(finishedPipelineCompiles);
+    }
+    
+    for (const PipelineCompileJob& job : finished) {
+        if (job.pipeline == VK_NULL_HANDLE) {
+            shaderStatus[job.shaderId] = VulkanShaderStatus::Failed;
+            continue;
+        }
+        
+        vertexShaders[job.shaderId] = job.vertShaderModule;
+        fragmentShaders[job.shaderId] = job.fragShaderModule;
+        shaderPipelines[job.shaderId] = job.pipeline;
+        shaderPipelineLayouts[job.shaderId] = job.layout;
+        shaderStatus[job.shaderId] = VulkanShaderStatus::Ready;
+        std::cout << "Loaded shader from " << job.vertexShaderFile << " and " << job.fragmentShaderFile
+                  << " with ID: " << job.shaderId << std::endl;
+        
+        // Takes effect from the next recorded shape; already recorded draws keep the fallback
+        if (job.shaderId == activeShaderId) {
+            activePipeline = job.pipeline;
+        }
+    }
+}
+
+void VulkanRenderer::SetSurface(unsigned int width, unsigned int height)
+{
+    // Called on every step of a viewport drag, so only flag the rebuild; BeginFrame does it once
+    if (width != surfaceWidth || height != surfaceHeight) {
+        surfaceWidth = width;
+        surfaceHeight = height;
+        swapchainDirty = logicalDevice != VK_NULL_HANDLE;
+    }
+}
+
+void VulkanRenderer::SetDrawColor(float r, float g, float b, float a)
+{
+    drawColor[0] = r;
+    drawColor[1] = g;
+    drawColor[2] = b;
+    drawColor[3] = a;
+}
+
+bool VulkanRenderer::SetFramesInFlight(uint32_t count)
+{
+    if (count < 1 || count > kMaxFramesInFlight || logicalDevice != VK_NULL_HANDLE) {
+        return false;
+    }
+    framesInFlight = count;
+    return true;
+}
+
+void VulkanRenderer::SetPresentMode(VulkanPresentMode mode)
+{
+    requestedPresentMode = mode;
+}
+
+const VulkanFrameTimingStats& VulkanRenderer::GetFrameTimingStats() const
+{
+    return frameTimingStats;
+}
+
+void VulkanRenderer::ResetFrameTimingStats()
+{
+    VulkanFrameTimingStats reset;
+    reset.framesInFlight = frameTimingStats.framesInFlight;
+    reset.presentMode = frameTimingStats.presentMode;
+    frameTimingStats = reset;
+}
+
+void VulkanRenderer::SetPipelineCachePath(const std::string& path)
+{
+    pipelineCachePath = path;
+}
+
+VulkanPipelineCacheStats VulkanRenderer::GetPipelineCacheStats() const
+{
+    // Compile threads update the pipeline counters
+    std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+    return pipelineCacheStats;
+}
+
+void VulkanRenderer::SetShaderDirectory(const std::string& directory)
+{
+    shaderDirectory = directory;
+    if (!shaderDirectory.empty() && shaderDirectory.back() != '/' && shaderDirectory.back() != '\\') {
+        shaderDirectory += '/';
+    }
+}
+
+// Helper methods implementation
+void VulkanRenderer::SetRecordingThreadCount(unsigned int threadCount)
+{
+    if (logicalDevice != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(logicalDevice);
+        DestroyRecordingContexts();
+    }
+    
+    recordingWorkers.Resize(threadCount);
+    
+    if (logicalDevice != VK_NULL_HANDLE && !CreateRecordingContexts()) {
+        std::cerr << "Failed to create recording command pools" << std::endl;
+    }
+}
+
+void VulkanRenderer::RecordLayers(uint32_t layerCount,
+                                  const std::function<void(VulkanLayerRecorder& recorder, uint32_t layer)>& recordLayer)
+{
+    if (!frameInProgress || layerCount == 0) {
+        return;
+    }
+    
+    auto recordStart = std::chrono::steady_clock::now();
+    
+    // Secondary command buffers need a render pass instance of their own, so finish the inline
+    // work and continue in a pass that keeps what has been drawn so far
+    FlushDrawBatch();
+    vkCmdEndRenderPass(commandBuffers[currentFrame]);
+    gpuTimer.BeginScope(commandBuffers[currentFrame], "Layers");
+    BeginRenderPassInstance(loadRenderPass, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+    
+    FrameVertexRing& ring = vertexRings[currentFrame];
+    FrameSpriteRing& spriteRing = spriteRings[currentFrame];
+    layerVertexCount.store(ring.vertexCount);
+    layerSpriteCount.store(spriteRing.spriteCount);
+    layerRingOverflowed.store(false);
+    
+    std::vector<VkCommandBuffer> layerBuffers(layerCount, VK_NULL_HANDLE);
+    recordingWorkers.ParallelFor(layerCount, [&](uint32_t layer, uint32_t threadIndex) {
+        VkCommandBuffer commandBuffer = AcquireSecondaryCommandBuffer(threadIndex);
+        if (commandBuffer == VK_NULL_HANDLE) {
+            return;
+        }
+        
+        VulkanLayerRecorder recorder(this, commandBuffer);
+        recordLayer(recorder, layer);
+        recorder.FlushDraw();
+        recorder.FlushSprites();
+        
+        if (vkEndCommandBuffer(commandBuffer) == VK_SUCCESS) {
+            layerBuffers[layer] = commandBuffer;
+        }
+    });
+    
+    // Executed in layer order regardless of which thread finished first
+    layerBuffers.erase(std::remove(layerBuffers.begin(), layerBuffers.end(), VK_NULL_HANDLE), layerBuffers.end());
+    if (!layerBuffers.empty()) {
+        vkCmdExecuteCommands(commandBuffers[currentFrame], (uint32_t)layerBuffers.size(), layerBuffers.data());
+    }
+    
+    if (layerRingOverflowed.load()) {
+        std::cerr << "Vulkan vertex ring full, layers were truncated" << std::endl;
+    }
+    ring.vertexCount = std::min(layerVertexCount.load(), kMaxVerticesPerFrame);
+    spriteRing.spriteCount = std::min(layerSpriteCount.load(), kMaxSpritesPerFrame);
+    
+    vkCmdEndRenderPass(commandBuffers[currentFrame]);
+    gpuTimer.EndScope(commandBuffers[currentFrame]);
+    BeginRenderPassInstance(loadRenderPass, VK_SUBPASS_CONTENTS_INLINE);
+    boundPipeline = VK_NULL_HANDLE;
+    batchFirstVertex = ring.vertexCount;
+    batchVertexCount = 0;
+    spriteBatchFirst = spriteRing.spriteCount;
+    spriteBatchCount = 0;
+    
+    recordingStats.threadCount = recordingWorkers.GetThreadCount();
+    recordingStats.layerCount = layerCount;
+    recordingStats.recordMs = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - recordStart).count();
+}
+
+const VulkanRecordingStats& VulkanRenderer::GetRecordingStats() const
+{
+    return recordingStats;
+}
+
+bool VulkanRenderer::CreateInstance()
+{
+    VkApplicationInfo appInfo{};
+    appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+    appInfo.pApplicationName = "Game Engine";
+    appInfo.applicationVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.pEngineName = "No Engine";
+    appInfo.engineVersion = VK_MAKE_VERSION(1, 0, 0);
+    appInfo.apiVersion = VK_API_VERSION_1_2; // timeline semaphores
+
+    uint32_t extensionCount = 0;
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, nullptr);
+    std::vector<VkExtensionProperties> extensions(extensionCount);
+    vkEnumerateInstanceExtensionProperties(nullptr, &extensionCount, extensions.data());
+
+    // Offscreen mode needs no window system integration at all
+    std::vector<const char*> enabledExtensions;
+    if (!offscreen) {
+        enabledExtensions.push_back(VK_KHR_SURFACE_EXTENSION_NAME);
+#ifdef _WIN32
+        enabledExtensions.push_back(VK_KHR_WIN32_SURFACE_EXTENSION_NAME);
+#endif
+    }
+    for (const char* required : enabledExtensions) {
+        bool found = std::any_of(extensions.begin(), extensions.end(), [required](const VkExtensionProperties& extension) {
+            return strcmp(extension.extensionName, required) == 0;
+        });
+        if (!found) {
+            std::cerr << "Missing Vulkan instance extension " << required << std::endl;
+            return false;
+        }
+    }
+
+    VkInstanceCreateInfo createInfo{};
+    createInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
     createInfo.pApplicationInfo = &appInfo;
-    createInfo.enabledExtensionCount = 0;
-    createInfo.ppEnabledExtensionNames = nullptr;
+    createInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+    createInfo.ppEnabledExtensionNames = enabledExtensions.data();
     createInfo.enabledLayerCount = 0;
     createInfo.ppEnabledLayerNames = nullptr;
 
@@ -501,6 +1072,7 @@ bool VulkanRenderer::CreateInstance()
 
 bool VulkanRenderer::CreateSurface()
 {
+#ifdef _WIN32
     // On Windows, we need to use Win32 surface
     VkWin32SurfaceCreateInfoKHR createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_WIN32_SURFACE_CREATE_INFO_KHR;
@@ -508,6 +1080,10 @@ bool VulkanRenderer::CreateSurface()
     createInfo.hinstance = GetModuleHandle(nullptr);
 
     return vkCreateWin32SurfaceKHR(instance, &createInfo, nullptr, &surface) == VK_SUCCESS;
+#else
+    // Only offscreen rendering is supported off Windows
+    return false;
+#endif
 }
 
 bool VulkanRenderer::PickPhysicalDevice()
@@ -537,7 +1113,8 @@ bool VulkanRenderer::CreateLogicalDevice()
     QueueFamilyIndices indices = FindQueueFamilies(physicalDevice);
 
     std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value()};
+    std::set<uint32_t> uniqueQueueFamilies = {indices.graphicsFamily.value(), indices.presentFamily.value(),
+                                              indices.transferFamily.value()};
 
     float queuePriority = 1.0f;
     for (uint32_t queueFamily : uniqueQueueFamilies) {
@@ -551,17 +1128,36 @@ bool VulkanRenderer::CreateLogicalDevice()
 
     VkPhysicalDeviceFeatures deviceFeatures{};
 
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    vulkan12Features.timelineSemaphore = VK_TRUE;
+    vulkan12Features.runtimeDescriptorArray = VK_TRUE;
+    vulkan12Features.descriptorBindingPartiallyBound = VK_TRUE;
+    vulkan12Features.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+    vulkan12Features.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+
     VkDeviceCreateInfo createInfo{};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+    createInfo.pNext = &vulkan12Features;
     createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
     createInfo.pQueueCreateInfos = queueCreateInfos.data();
     createInfo.pEnabledFeatures = &deviceFeatures;
-    createInfo.enabledExtensionCount = 0;
-    createInfo.ppEnabledExtensionNames = nullptr;
+    const char* swapchainExtension = VK_KHR_SWAPCHAIN_EXTENSION_NAME;
+    createInfo.enabledExtensionCount = offscreen ? 0 : 1;
+    createInfo.ppEnabledExtensionNames = offscreen ? nullptr : &swapchainExtension;
     createInfo.enabledLayerCount = 0;
     createInfo.ppEnabledLayerNames = nullptr;
 
-    return vkCreateDevice(physicalDevice, &createInfo, nullptr, &logicalDevice) == VK_SUCCESS;
+    if (vkCreateDevice(physicalDevice, &createInfo, nullptr, &logicalDevice) != VK_SUCCESS) {
+        return false;
+    }
+
+    graphicsQueueFamily = indices.graphicsFamily.value();
+    transferQueueFamily = indices.transferFamily.value();
+    vkGetDeviceQueue(logicalDevice, graphicsQueueFamily, 0, &graphicsQueue);
+    vkGetDeviceQueue(logicalDevice, indices.presentFamily.value(), 0, &presentQueue);
+    vkGetDeviceQueue(logicalDevice, transferQueueFamily, 0, &transferQueue);
+    return true;
 }
 
 bool VulkanRenderer::CreateSwapchain()
@@ -605,7 +1201,8 @@ bool VulkanRenderer::CreateSwapchain()
     createInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     createInfo.presentMode = presentMode;
     createInfo.clipped = VK_TRUE;
-    createInfo.oldSwapchain = VK_NULL_HANDLE;
+    // Lets the driver hand resources over from the swapchain being replaced
+    createInfo.oldSwapchain = swapchain;
 
     bool success = vkCreateSwapchainKHR(logicalDevice, &createInfo, nullptr, &swapchain) == VK_SUCCESS;
     
@@ -621,6 +1218,229 @@ bool VulkanRenderer::CreateSwapchain()
     return success;
 }
 
+bool VulkanRenderer::RecreateSwapchain()
+{
+    if (offscreen) {
+        // Nothing is presented, so a full drain costs no visible frame; it also keeps
+        // ReadbackFrame from mixing targets of two sizes
+        vkDeviceWaitIdle(logicalDevice);
+        for (auto framebuffer : swapchainFramebuffers) {
+            vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+        }
+        for (auto imageView : swapchainImageViews) {
+            vkDestroyImageView(logicalDevice, imageView, nullptr);
+        }
+        swapchainFramebuffers.clear();
+        swapchainImageViews.clear();
+        DestroyOffscreenTargets();
+        lastSubmittedFrame = SIZE_MAX;
+        swapchainDirty = false;
+        return CreateOffscreenTargets() && CreateImageViews() && CreateFramebuffers();
+    }
+    
+    // A minimized window reports a zero extent; keep the current swapchain until it comes back
+    SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(physicalDevice);
+    VkExtent2D extent = ChooseSwapExtent(swapChainSupport.capabilities);
+    if (extent.width == 0 || extent.height == 0) {
+        return false;
+    }
+    
+    // Frames still in flight keep using the old objects, so instead of draining the device
+    // they are retired and destroyed once those frames' fences have signaled
+    RetiredSwapchain retired;
+    retired.swapchain = swapchain;
+    retired.imageViews = std::move(swapchainImageViews);
+    retired.framebuffers = std::move(swapchainFramebuffers);
+    retired.retiredAtFrame = submittedFrames;
+    swapchainImageViews.clear();
+    swapchainFramebuffers.clear();
+    
+    VkFormat previousFormat = swapchainImageFormat;
+    bool created = CreateSwapchain();
+    // The old swapchain is retired by vkCreateSwapchainKHR even when it fails
+    retiredSwapchains.push_back(std::move(retired));
+    if (!created) {
+        swapchain = VK_NULL_HANDLE;
+        return false;
+    }
+    
+    imagesInFlight.assign(swapchainImages.size(), VK_NULL_HANDLE);
+    // Cleared even on failure so a broken rebuild is reported once instead of replacing the swapchain every frame
+    swapchainDirty = false;
+    // A null sprite pipeline (the last object rebuilt) means an earlier format rebuild failed; retry it
+    bool rebuildPasses = swapchainImageFormat != previousFormat || spritePipeline == VK_NULL_HANDLE;
+    if (rebuildPasses && !RecreateRenderPassAndPipelines()) {
+        std::cerr << "Failed to rebuild render passes for the new swapchain format" << std::endl;
+        return false;
+    }
+    return CreateImageViews() && CreateFramebuffers();
+}
+
+bool VulkanRenderer::RecreateRenderPassAndPipelines()
+{
+    // Pipelines are baked against the render pass, whose attachment format just changed.
+    // Format changes are rare (e.g. moving to an HDR monitor), so a full drain is acceptable here.
+    vkDeviceWaitIdle(logicalDevice);
+    ReleaseRetiredSwapchains(true);
+    
+    // Compile threads read renderPass; park them, keeping the jobs they have not started
+    std::deque<PipelineCompileJob> queued;
+    {
+        std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+        queued.swap(queuedPipelineCompiles);
+        pipelineCompilesInProgress -= (unsigned int)queued.size();
+    }
+    StopPipelineCompileThreads();
+    
+    vkDestroyPipeline(logicalDevice, graphicsPipeline, nullptr);
+    vkDestroyPipeline(logicalDevice, spritePipeline, nullptr);
+    vkDestroyPipelineLayout(logicalDevice, pipelineLayout, nullptr);
+    vkDestroyRenderPass(logicalDevice, renderPass, nullptr);
+    vkDestroyRenderPass(logicalDevice, loadRenderPass, nullptr);
+    graphicsPipeline = VK_NULL_HANDLE;
+    spritePipeline = VK_NULL_HANDLE;
+    pipelineLayout = VK_NULL_HANDLE;
+    renderPass = VK_NULL_HANDLE;
+    loadRenderPass = VK_NULL_HANDLE;
+    
+    bool success = CreateRenderPass() && CreateGraphicsPipeline();
+    
+    // Loaded shaders keep their modules and layouts, so only the pipelines are rebuilt
+    for (auto it = shaderPipelines.begin(); it != shaderPipelines.end();) {
+        vkDestroyPipeline(logicalDevice, it->second, nullptr);
+        it->second = VK_NULL_HANDLE;
+        if (!success || !CreatePipeline(vertexShaders[it->first], fragmentShaders[it->first],
+                                        shaderPipelineLayouts[it->first], it->second)) {
+            shaderStatus[it->first] = VulkanShaderStatus::Failed;
+            it = shaderPipelines.erase(it);
+            continue;
+        }
+        ++it;
+    }
+    UseShader(activeShaderId);
+    
+    StartPipelineCompileThreads();
+    {
+        std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+        pipelineCompilesInProgress += (unsigned int)queued.size();
+        queuedPipelineCompiles.swap(queued);
+    }
+    pipelineCompileAvailable.notify_all();
+    return success;
+}
+
+void VulkanRenderer::ReleaseRetiredSwapchains(bool waitIdle)
+{
+    // Submissions complete in order and the current slot's fence has signaled, so every frame
+    // submitted more than framesInFlight - 1 frames ago is done
+    uint64_t completedFrames = submittedFrames + 1 >= framesInFlight ? submittedFrames + 1 - framesInFlight : 0;
+    
+    auto it = retiredSwapchains.begin();
+    while (it != retiredSwapchains.end()) {
+        if (!waitIdle && it->retiredAtFrame > completedFrames) {
+            ++it;
+            continue;
+        }
+        for (auto framebuffer : it->framebuffers) {
+            vkDestroyFramebuffer(logicalDevice, framebuffer, nullptr);
+        }
+        for (auto imageView : it->imageViews) {
+            vkDestroyImageView(logicalDevice, imageView, nullptr);
+        }
+        vkDestroySwapchainKHR(logicalDevice, it->swapchain, nullptr);
+        it = retiredSwapchains.erase(it);
+    }
+}
+
+bool VulkanRenderer::CreateOffscreenTargets()
+{
+    // One target per frame in flight so the CPU can read one frame back while the next is rendered
+    const uint32_t targetCount = framesInFlight;
+    swapchainImageFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    swapchainExtent = {std::max(1u, surfaceWidth), std::max(1u, surfaceHeight)};
+    VkDeviceSize readbackSize = (VkDeviceSize)swapchainExtent.width * swapchainExtent.height * 4;
+
+    offscreenTargets.resize(targetCount);
+    swapchainImages.resize(targetCount);
+    for (uint32_t i = 0; i < targetCount; i++) {
+        OffscreenTarget& target = offscreenTargets[i];
+        target = OffscreenTarget{};
+
+        VkImageCreateInfo imageInfo{};
+        imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+        imageInfo.imageType = VK_IMAGE_TYPE_2D;
+        imageInfo.format = swapchainImageFormat;
+        imageInfo.extent = {swapchainExtent.width, swapchainExtent.height, 1};
+        imageInfo.mipLevels = 1;
+        imageInfo.arrayLayers = 1;
+        imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+        imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+        imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+        imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+        if (vkCreateImage(logicalDevice, &imageInfo, nullptr, &target.image) != VK_SUCCESS) {
+            return false;
+        }
+
+        VkMemoryRequirements memRequirements;
+        vkGetImageMemoryRequirements(logicalDevice, target.image, &memRequirements);
+        if (!memoryAllocator.Allocate(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                      VulkanResourceKind::Optimal, target.allocation) ||
+            vkBindImageMemory(logicalDevice, target.image, target.allocation.memory,
+                              target.allocation.offset) != VK_SUCCESS) {
+            return false;
+        }
+        swapchainImages[i] = target.image;
+
+        try {
+            CreateBuffer(readbackSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         target.readbackBuffer, target.readbackAllocation);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return false;
+        }
+        
+        // ReadbackFrame copies straight out of the persistent mapping
+        if (!target.readbackAllocation.mapped) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void VulkanRenderer::DestroyOffscreenTargets()
+{
+    for (OffscreenTarget& target : offscreenTargets) {
+        if (target.image != VK_NULL_HANDLE) {
+            vkDestroyImage(logicalDevice, target.image, nullptr);
+            memoryAllocator.Free(target.allocation);
+        }
+        if (target.readbackBuffer != VK_NULL_HANDLE) {
+            DestroyBuffer(target.readbackBuffer, target.readbackAllocation);
+        }
+    }
+    offscreenTargets.clear();
+}
+
+bool VulkanRenderer::ReadbackFrame(std::vector<unsigned char>& pixels, uint32_t& width, uint32_t& height)
+{
+    if (!offscreen || lastSubmittedFrame == SIZE_MAX) {
+        return false;
+    }
+
+    // Frame slot and target index are the same in offscreen mode
+    vkWaitForFences(logicalDevice, 1, &inFlightFences[lastSubmittedFrame], VK_TRUE, UINT64_MAX);
+
+    const OffscreenTarget& target = offscreenTargets[lastSubmittedFrame];
+    width = swapchainExtent.width;
+    height = swapchainExtent.height;
+    pixels.resize((size_t)width * height * 4);
+    memcpy(pixels.data(), target.readbackAllocation.mapped, pixels.size());
+    return true;
+}
+
 bool VulkanRenderer::CreateImageViews()
 {
     swapchainImageViews.resize(swapchainImages.size());
@@ -659,7 +1479,8 @@ bool VulkanRenderer::CreateRenderPass()
     colorAttachment.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
     colorAttachment.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
     colorAttachment.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
-    colorAttachment.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+    // Offscreen targets are copied out for readback instead of presented
+    colorAttachment.finalLayout = offscreen ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
 
     VkAttachmentReference colorAttachmentRef{};
     colorAttachmentRef.attachment = 0;
@@ -670,7 +1491,8 @@ bool VulkanRenderer::CreateRenderPass()
     subpass.colorAttachmentCount = 1;
     subpass.pColorAttachments = &colorAttachmentRef;
 
-    VkSubpassDependency dependency{};
+    VkSubpassDependency dependencies[2]{};
+    VkSubpassDependency& dependency = dependencies[0];
     dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
     dependency.dstSubpass = 0;
     dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
@@ -678,87 +1500,188 @@ bool VulkanRenderer::CreateRenderPass()
     dependency.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
     dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
 
+    // Offscreen: the previous readback of this target must finish before it is drawn over,
+    // and the readback copy recorded after the pass must see the finished color writes
+    VkSubpassDependency& readbackDependency = dependencies[1];
+    readbackDependency.srcSubpass = 0;
+    readbackDependency.dstSubpass = VK_SUBPASS_EXTERNAL;
+    readbackDependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
+    readbackDependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    readbackDependency.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+    readbackDependency.dstAccessMask = VK_ACCESS_TRANSFER_READ_BIT;
+    if (offscreen) {
+        dependency.srcStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+    }
+
     VkRenderPassCreateInfo renderPassInfo{};
     renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
     renderPassInfo.attachmentCount = 1;
     renderPassInfo.pAttachments = &colorAttachment;
     renderPassInfo.subpassCount = 1;
     renderPassInfo.pSubpasses = &subpass;
-    renderPassInfo.dependencyCount = 1;
-    renderPassInfo.pDependencies = &dependency;
+    renderPassInfo.dependencyCount = offscreen ? 2 : 1;
+    renderPassInfo.pDependencies = dependencies;
 
-    return vkCreateRenderPass(logicalDevice, &renderPassInfo, nullptr, &renderPass) == VK_SUCCESS;
+    if (vkCreateRenderPass(logicalDevice, &renderPassInfo, nullptr, &renderPass) != VK_SUCCESS) {
+        return false;
+    }
+
+    // Compatible pass used to resume drawing after RecordLayers without clearing
+    colorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_LOAD;
+    colorAttachment.initialLayout = colorAttachment.finalLayout;
+    dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+    dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+    return vkCreateRenderPass(logicalDevice, &renderPassInfo, nullptr, &loadRenderPass) == VK_SUCCESS;
 }
 
 bool VulkanRenderer::CreateGraphicsPipeline()
 {
-    // Define a simple vertex shader stage
-    const std::vector<char> vertShaderCode = {
-        // This would be actual SPIR-V bytecode in a real implementation
-        // For this example, we'll create a basic pipeline without actual shader modules
-    };
+    // Built-in shaders are compiled from Renderer/Shaders by the build
+    std::vector<char> vertShaderCode = ReadShaderFile(shaderDirectory + "basic.vert.spv");
+    std::vector<char> fragShaderCode = ReadShaderFile(shaderDirectory + "basic.frag.spv");
     
-    // Define a simple fragment shader stage
-    const std::vector<char> fragShaderCode = {
-        // This would be actual SPIR-V bytecode in a real implementation
-    };
-
-    // Create shader stage creation info
-    VkShaderModule vertShaderModule = VK_NULL_HANDLE; // In a real implementation, this would be created from bytecode
-    VkShaderModule fragShaderModule = VK_NULL_HANDLE; // In a real implementation, this would be created from bytecode
-    
-    // For this example, we'll create placeholder shader modules with a dummy implementation
-    // Create a basic vertex shader module
-    VkShaderModuleCreateInfo vertShaderCreateInfo{};
-    vertShaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    vertShaderCreateInfo.codeSize = sizeof(uint32_t); // Placeholder size
-    vertShaderCreateInfo.pCode = nullptr; // Placeholder pointer
-    
-    VkShaderModuleCreateInfo fragShaderCreateInfo{};
-    fragShaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    fragShaderCreateInfo.codeSize = sizeof(uint32_t); // Placeholder size
-    fragShaderCreateInfo.pCode = nullptr; // Placeholder pointer
+    if (vertShaderCode.empty() || fragShaderCode.empty()) {
+        return false;
+    }
     
-    // In a real implementation, we would load actual SPIR-V bytecode from files
-    // For now, we'll just create a simple pipeline with fixed shaders
+    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
+    VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
+
+    bool success = vertShaderModule != VK_NULL_HANDLE && fragShaderModule != VK_NULL_HANDLE &&
+                   CreatePipelineLayout(pipelineLayout) &&
+                   CreatePipeline(vertShaderModule, fragShaderModule, pipelineLayout, graphicsPipeline);
     
-    // Create pipeline layout
+    // Shader modules are only needed while the pipeline is being created
+    if (vertShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(logicalDevice, vertShaderModule, nullptr);
+    }
+    if (fragShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(logicalDevice, fragShaderModule, nullptr);
+    }
+
+    return success && CreateSpritePipeline();
+}
+
+bool VulkanRenderer::CreatePipelineLayout(VkPipelineLayout& layout)
+{
+    // Every pipeline gets the same layout (bindless textures plus the view push constants),
+    // so descriptors and push constants stay bound when pipelines are switched
+    VkPushConstantRange pushConstantRange{};
+    pushConstantRange.stageFlags = VK_SHADER_STAGE_VERTEX_BIT;
+    pushConstantRange.offset = 0;
+    pushConstantRange.size = sizeof(VulkanViewPushConstants);
+
     VkPipelineLayoutCreateInfo pipelineLayoutInfo{};
     pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-    pipelineLayoutInfo.setLayoutCount = 0;
-    pipelineLayoutInfo.pSetLayouts = nullptr;
-    pipelineLayoutInfo.pushConstantRangeCount = 0;
-    pipelineLayoutInfo.pPushConstantRanges = nullptr;
+    pipelineLayoutInfo.setLayoutCount = 1;
+    pipelineLayoutInfo.pSetLayouts = &textureSetLayout;
+    pipelineLayoutInfo.pushConstantRangeCount = 1;
+    pipelineLayoutInfo.pPushConstantRanges = &pushConstantRange;
 
-    if (vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, nullptr, &pipelineLayout) != VK_SUCCESS) {
-        std::cerr << "Failed to create pipeline layout" << std::endl;
+    return vkCreatePipelineLayout(logicalDevice, &pipelineLayoutInfo, nullptr, &layout) == VK_SUCCESS;
+}
+
+bool VulkanRenderer::CreateSpritePipeline()
+{
+    // The sprite vertex shader feeds the same fragment interface as basic.vert
+    std::vector<char> vertShaderCode = ReadShaderFile(shaderDirectory + "sprite.vert.spv");
+    std::vector<char> fragShaderCode = ReadShaderFile(shaderDirectory + "basic.frag.spv");
+    if (vertShaderCode.empty() || fragShaderCode.empty()) {
         return false;
     }
 
-    // Define shader stages
+    VkShaderModule vertShaderModule = CreateShaderModule(vertShaderCode);
+    VkShaderModule fragShaderModule = CreateShaderModule(fragShaderCode);
+
+    // Per-instance attributes only (see VulkanSprite); corners come from gl_VertexIndex
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 1;
+    bindingDescription.stride = sizeof(VulkanSprite);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_INSTANCE;
+
+    VkVertexInputAttributeDescription attributeDescriptions[6]{};
+    const VkFormat formats[6] = {VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT,
+                                 VK_FORMAT_R32G32B32A32_SFLOAT, VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32_UINT};
+    const uint32_t offsets[6] = {offsetof(VulkanSprite, position), offsetof(VulkanSprite, size),
+                                 offsetof(VulkanSprite, uvRect), offsetof(VulkanSprite, color),
+                                 offsetof(VulkanSprite, rotation), offsetof(VulkanSprite, textureId)};
+    for (uint32_t i = 0; i < 6; i++) {
+        attributeDescriptions[i].binding = 1;
+        attributeDescriptions[i].location = i;
+        attributeDescriptions[i].format = formats[i];
+        attributeDescriptions[i].offset = offsets[i];
+    }
+
+    VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
+    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = 6;
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions;
+
+    bool success = vertShaderModule != VK_NULL_HANDLE && fragShaderModule != VK_NULL_HANDLE &&
+                   CreatePipeline(vertShaderModule, fragShaderModule, pipelineLayout, spritePipeline, &vertexInputInfo);
+
+    if (vertShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(logicalDevice, vertShaderModule, nullptr);
+    }
+    if (fragShaderModule != VK_NULL_HANDLE) {
+        vkDestroyShaderModule(logicalDevice, fragShaderModule, nullptr);
+    }
+
+    return success;
+}
+
+bool VulkanRenderer::CreatePipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule,
+                                    VkPipelineLayout layout, VkPipeline& pipeline,
+                                    const VkPipelineVertexInputStateCreateInfo* vertexInput)
+{
+    // Create shader stage creation info
     VkPipelineShaderStageCreateInfo vertShaderStageInfo{};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     vertShaderStageInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-    vertShaderStageInfo.module = vertShaderModule; // Placeholder
+    vertShaderStageInfo.module = vertShaderModule;
     vertShaderStageInfo.pName = "main";
-    vertShaderStageInfo.pSpecializationInfo = nullptr;
 
     VkPipelineShaderStageCreateInfo fragShaderStageInfo{};
     fragShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
     fragShaderStageInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-    fragShaderStageInfo.module = fragShaderModule; // Placeholder
+    fragShaderStageInfo.module = fragShaderModule;
     fragShaderStageInfo.pName = "main";
-    fragShaderStageInfo.pSpecializationInfo = nullptr;
 
     VkPipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
-    // Vertex input state
+    // Vertex input state (see VulkanVertex)
+    VkVertexInputBindingDescription bindingDescription{};
+    bindingDescription.binding = 0;
+    bindingDescription.stride = sizeof(VulkanVertex);
+    bindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+
+    VkVertexInputAttributeDescription attributeDescriptions[4]{};
+    attributeDescriptions[0].binding = 0;
+    attributeDescriptions[0].location = 0;
+    attributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;
+    attributeDescriptions[0].offset = offsetof(VulkanVertex, position);
+    attributeDescriptions[1].binding = 0;
+    attributeDescriptions[1].location = 1;
+    attributeDescriptions[1].format = VK_FORMAT_R32G32B32A32_SFLOAT;
+    attributeDescriptions[1].offset = offsetof(VulkanVertex, color);
+    attributeDescriptions[2].binding = 0;
+    attributeDescriptions[2].location = 2;
+    attributeDescriptions[2].format = VK_FORMAT_R32G32_SFLOAT;
+    attributeDescriptions[2].offset = offsetof(VulkanVertex, uv);
+    attributeDescriptions[3].binding = 0;
+    attributeDescriptions[3].location = 3;
+    attributeDescriptions[3].format = VK_FORMAT_R32_UINT;
+    attributeDescriptions[3].offset = offsetof(VulkanVertex, textureIndex);
+
     VkPipelineVertexInputStateCreateInfo vertexInputInfo{};
     vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 0;
-    vertexInputInfo.pVertexBindingDescriptions = nullptr;
-    vertexInputInfo.vertexAttributeDescriptionCount = 0;
-    vertexInputInfo.pVertexAttributeDescriptions = nullptr;
+    vertexInputInfo.vertexBindingDescriptionCount = 1;
+    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfo.vertexAttributeDescriptionCount = 4;
+    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions;
 
     // Input assembly
     VkPipelineInputAssemblyStateCreateInfo inputAssembly{};
@@ -766,34 +1689,26 @@ bool VulkanRenderer::CreateGraphicsPipeline()
     inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
     inputAssembly.primitiveRestartEnable = VK_FALSE;
 
-    // Viewport and scissor
-    VkViewport viewport{};
-    viewport.x = 0.0f;
-    viewport.y = 0.0f;
-    viewport.width = (float)swapchainExtent.width;
-    viewport.height = (float)swapchainExtent.height;
-    viewport.minDepth = 0.0f;
-    viewport.maxDepth = 1.0f;
-
-    VkRect2D scissor{};
-    scissor.offset = {0, 0};
-    scissor.extent = swapchainExtent;
-
+    // Viewport and scissor are set per frame
     VkPipelineViewportStateCreateInfo viewportState{};
     viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
     viewportState.viewportCount = 1;
-    viewportState.pViewports = &viewport;
     viewportState.scissorCount = 1;
-    viewportState.pScissors = &scissor;
 
-    // Rasterizer
+    VkDynamicState dynamicStates[] = {VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    VkPipelineDynamicStateCreateInfo dynamicState{};
+    dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+    dynamicState.dynamicStateCount = 2;
+    dynamicState.pDynamicStates = dynamicStates;
+
+    // Rasterizer (2D shapes come in either winding, so nothing is culled)
     VkPipelineRasterizationStateCreateInfo rasterizer{};
     rasterizer.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
     rasterizer.depthClampEnable = VK_FALSE;
     rasterizer.rasterizerDiscardEnable = VK_FALSE;
     rasterizer.polygonMode = VK_POLYGON_MODE_FILL;
     rasterizer.lineWidth = 1.0f;
-    rasterizer.cullMode = VK_CULL_MODE_BACK_BIT;
+    rasterizer.cullMode = VK_CULL_MODE_NONE;
     rasterizer.frontFace = VK_FRONT_FACE_CLOCKWISE;
     rasterizer.depthBiasEnable = VK_FALSE;
     rasterizer.depthBiasConstantFactor = 0.0f;
@@ -810,16 +1725,16 @@ bool VulkanRenderer::CreateGraphicsPipeline()
     multisampling.alphaToCoverageEnable = VK_FALSE;
     multisampling.alphaToOneEnable = VK_FALSE;
 
-    // Color blend state
+    // Color blend state (straight alpha, like the OpenGL backend)
     VkPipelineColorBlendAttachmentState colorBlendAttachment{};
     colorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | 
                                           VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-    colorBlendAttachment.blendEnable = VK_FALSE;
-    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.blendEnable = VK_TRUE;
+    colorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+    colorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     colorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
     colorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+    colorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
     colorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
 
     VkPipelineColorBlendStateCreateInfo colorBlending{};
@@ -838,26 +1753,325 @@ bool VulkanRenderer::CreateGraphicsPipeline()
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
+    pipelineInfo.pVertexInputState = vertexInput ? vertexInput : &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
     pipelineInfo.pMultisampleState = &multisampling;
     pipelineInfo.pDepthStencilState = nullptr;
     pipelineInfo.pColorBlendState = &colorBlending;
-    pipelineInfo.pDynamicState = nullptr;
-    pipelineInfo.layout = pipelineLayout;
+    pipelineInfo.pDynamicState = &dynamicState;
+    pipelineInfo.layout = layout;
     pipelineInfo.renderPass = renderPass;
     pipelineInfo.subpass = 0;
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    if (vkCreateGraphicsPipelines(logicalDevice, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &graphicsPipeline) != VK_SUCCESS) {
-        std::cerr << "Failed to create graphics pipeline" << std::endl;
+    // Called from the compile threads as well; the pipeline cache is internally synchronized
+    auto createStart = std::chrono::steady_clock::now();
+    VkResult result = vkCreateGraphicsPipelines(logicalDevice, pipelineCache, 1, &pipelineInfo, nullptr, &pipeline);
+    std::lock_guard<std::mutex> lock(pipelineCompileMutex);
+    pipelineCacheStats.pipelineCreateMs += std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - createStart).count();
+    if (result == VK_SUCCESS) {
+        pipelineCacheStats.pipelinesCreated++;
+    }
+    return result == VK_SUCCESS;
+}
+
+bool VulkanRenderer::CreateTextureDescriptors()
+{
+    VkPhysicalDeviceVulkan12Properties vulkan12Properties{};
+    vulkan12Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES;
+    VkPhysicalDeviceProperties2 properties{};
+    properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    properties.pNext = &vulkan12Properties;
+    vkGetPhysicalDeviceProperties2(physicalDevice, &properties);
+    
+    textureCapacity = std::min({kMaxBindlessTextures,
+                                vulkan12Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+                                vulkan12Properties.maxPerStageDescriptorUpdateAfterBindSampledImages});
+    
+    // Partially bound: only elements a draw actually indexes need a valid descriptor.
+    // Update after bind: LoadTexture can fill new elements while earlier frames are in flight.
+    VkDescriptorSetLayoutBinding binding{};
+    binding.binding = 0;
+    binding.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    binding.descriptorCount = textureCapacity;
+    binding.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+    
+    VkDescriptorBindingFlags bindingFlags = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+                                            VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT;
+    VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo{};
+    bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+    bindingFlagsInfo.bindingCount = 1;
+    bindingFlagsInfo.pBindingFlags = &bindingFlags;
+    
+    VkDescriptorSetLayoutCreateInfo layoutInfo{};
+    layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+    layoutInfo.pNext = &bindingFlagsInfo;
+    layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+    layoutInfo.bindingCount = 1;
+    layoutInfo.pBindings = &binding;
+    if (vkCreateDescriptorSetLayout(logicalDevice, &layoutInfo, nullptr, &textureSetLayout) != VK_SUCCESS) {
         return false;
     }
-
-    return true;
+    
+    VkDescriptorPoolSize poolSize{};
+    poolSize.type = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    poolSize.descriptorCount = textureCapacity;
+    
+    VkDescriptorPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+    poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+    poolInfo.maxSets = 1;
+    poolInfo.poolSizeCount = 1;
+    poolInfo.pPoolSizes = &poolSize;
+    if (vkCreateDescriptorPool(logicalDevice, &poolInfo, nullptr, &textureDescriptorPool) != VK_SUCCESS) {
+        return false;
+    }
+    
+    VkDescriptorSetAllocateInfo allocInfo{};
+    allocInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+    allocInfo.descriptorPool = textureDescriptorPool;
+    allocInfo.descriptorSetCount = 1;
+    allocInfo.pSetLayouts = &textureSetLayout;
+    if (vkAllocateDescriptorSets(logicalDevice, &allocInfo, &textureDescriptorSet) != VK_SUCCESS) {
+        return false;
+    }
+    
+    VkSamplerCreateInfo samplerInfo{};
+    samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+    samplerInfo.magFilter = VK_FILTER_LINEAR;
+    samplerInfo.minFilter = VK_FILTER_LINEAR;
+    samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+    samplerInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+    samplerInfo.maxLod = VK_LOD_CLAMP_NONE;
+    if (vkCreateSampler(logicalDevice, &samplerInfo, nullptr, &textureSampler) != VK_SUCCESS) {
+        return false;
+    }
+    
+    // Element 0 is plain white so untextured shapes can share batches with textured ones
+    const unsigned char white[4] = {255, 255, 255, 255};
+    return CreateTexture(white, 1, 1, 0);
+}
+
+void VulkanRenderer::DestroyTextureDescriptors()
+{
+    if (textureSampler != VK_NULL_HANDLE) {
+        vkDestroySampler(logicalDevice, textureSampler, nullptr);
+        textureSampler = VK_NULL_HANDLE;
+    }
+    // Destroying the pool frees the set
+    if (textureDescriptorPool != VK_NULL_HANDLE) {
+        vkDestroyDescriptorPool(logicalDevice, textureDescriptorPool, nullptr);
+        textureDescriptorPool = VK_NULL_HANDLE;
+        textureDescriptorSet = VK_NULL_HANDLE;
+    }
+    if (textureSetLayout != VK_NULL_HANDLE) {
+        vkDestroyDescriptorSetLayout(logicalDevice, textureSetLayout, nullptr);
+        textureSetLayout = VK_NULL_HANDLE;
+    }
+    currentTextureIndex = 0;
+}
+
+bool VulkanRenderer::CreateTexture(const unsigned char* pixels, uint32_t width, uint32_t height, unsigned int textureId)
+{
+    uint32_t queueFamilies[2];
+    uint32_t queueFamilyCount = 0;
+    
+    VkImageCreateInfo imageInfo{};
+    imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+    imageInfo.imageType = VK_IMAGE_TYPE_2D;
+    imageInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    imageInfo.extent = {width, height, 1};
+    imageInfo.mipLevels = 1;
+    imageInfo.arrayLayers = 1;
+    imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+    imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+    imageInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+    imageInfo.sharingMode = GetResourceSharing(queueFamilies, queueFamilyCount);
+    imageInfo.queueFamilyIndexCount = queueFamilyCount;
+    imageInfo.pQueueFamilyIndices = queueFamilies;
+    imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    
+    VulkanTexture texture{};
+    texture.width = width;
+    texture.height = height;
+    if (vkCreateImage(logicalDevice, &imageInfo, nullptr, &texture.image) != VK_SUCCESS) {
+        return false;
+    }
+    
+    VkMemoryRequirements memRequirements;
+    vkGetImageMemoryRequirements(logicalDevice, texture.image, &memRequirements);
+    if (!memoryAllocator.Allocate(memRequirements, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT,
+                                  VulkanResourceKind::Optimal, texture.allocation)) {
+        vkDestroyImage(logicalDevice, texture.image, nullptr);
+        return false;
+    }
+    vkBindImageMemory(logicalDevice, texture.image, texture.allocation.memory, texture.allocation.offset);
+    
+    VkImageViewCreateInfo viewInfo{};
+    viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+    viewInfo.image = texture.image;
+    viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+    viewInfo.format = VK_FORMAT_R8G8B8A8_UNORM;
+    viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    viewInfo.subresourceRange.baseMipLevel = 0;
+    viewInfo.subresourceRange.levelCount = 1;
+    viewInfo.subresourceRange.baseArrayLayer = 0;
+    viewInfo.subresourceRange.layerCount = 1;
+    
+    // Recorded into the current upload batch; the next frame waits for it on the GPU
+    if (vkCreateImageView(logicalDevice, &viewInfo, nullptr, &texture.view) != VK_SUCCESS ||
+        !stagingRing.UploadImage(pixels, (VkDeviceSize)width * height * 4, texture.image, width, height)) {
+        if (texture.view != VK_NULL_HANDLE) {
+            vkDestroyImageView(logicalDevice, texture.view, nullptr);
+        }
+        vkDestroyImage(logicalDevice, texture.image, nullptr);
+        memoryAllocator.Free(texture.allocation);
+        return false;
+    }
+    
+    // The element is not referenced by any submitted work yet, so writing it needs no synchronization
+    VkDescriptorImageInfo imageDescriptor{};
+    imageDescriptor.sampler = textureSampler;
+    imageDescriptor.imageView = texture.view;
+    imageDescriptor.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    
+    VkWriteDescriptorSet write{};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = textureDescriptorSet;
+    write.dstBinding = 0;
+    write.dstArrayElement = textureId;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    write.pImageInfo = &imageDescriptor;
+    vkUpdateDescriptorSets(logicalDevice, 1, &write, 0, nullptr);
+    
+    textures[textureId] = texture;
+    return true;
+}
+
+uint32_t VulkanRenderer::GetTextureIndex(unsigned int textureId) const
+{
+    // Unknown IDs fall back to the white texture rather than an unwritten descriptor
+    return textures.count(textureId) ? textureId : 0;
+}
+
+void VulkanRenderer::BindFrameBuffers(VkCommandBuffer commandBuffer)
+{
+    // This frame's rings were last read by the submission the frame fence waited for.
+    // Shapes read binding 0, sprites binding 1, so switching between them needs no rebind.
+    VkBuffer buffers[] = {vertexRings[currentFrame].buffer, spriteRings[currentFrame].buffer};
+    VkDeviceSize offsets[] = {0, 0};
+    vkCmdBindVertexBuffers(commandBuffer, 0, 2, buffers, offsets);
+    
+    // Same layout for every pipeline, so this survives pipeline switches too
+    vkCmdPushConstants(commandBuffer, pipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0,
+                       sizeof(VulkanViewPushConstants), &spriteView);
+}
+
+void VulkanRenderer::BindTextureDescriptors(VkCommandBuffer commandBuffer)
+{
+    // Every pipeline layout starts with the texture set layout, so this binding survives pipeline switches
+    vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipelineLayout, 0, 1,
+                            &textureDescriptorSet, 0, nullptr);
+}
+
+bool VulkanRenderer::CreatePipelineCache()
+{
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(physicalDevice, &properties);
+    
+    // Only hand the driver data written by the same device and driver build; anything else is ignored
+    std::vector<char> cacheData;
+    std::ifstream file(pipelineCachePath, std::ios::ate | std::ios::binary);
+    if (file.is_open()) {
+        cacheData.resize((size_t)file.tellg());
+        file.seekg(0);
+        file.read(cacheData.data(), cacheData.size());
+        
+        // VkPipelineCacheHeaderVersionOne: headerSize, headerVersion, vendorID, deviceID, pipelineCacheUUID
+        const size_t headerSize = 4 * sizeof(uint32_t) + VK_UUID_SIZE;
+        uint32_t header[4] = {};
+        bool valid = file.good() && cacheData.size() >= headerSize;
+        if (valid) {
+            memcpy(header, cacheData.data(), sizeof(header));
+            valid = header[0] >= headerSize && header[0] <= cacheData.size() &&
+                    header[1] == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+                    header[2] == properties.vendorID &&
+                    header[3] == properties.deviceID &&
+                    memcmp(cacheData.data() + sizeof(header), properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+        }
+        if (!valid) {
+            std::cerr << "Ignoring stale pipeline cache " << pipelineCachePath << std::endl;
+            cacheData.clear();
+        }
+    }
+    
+    VkPipelineCacheCreateInfo cacheInfo{};
+    cacheInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    cacheInfo.initialDataSize = cacheData.size();
+    cacheInfo.pInitialData = cacheData.empty() ? nullptr : cacheData.data();
+    
+    if (vkCreatePipelineCache(logicalDevice, &cacheInfo, nullptr, &pipelineCache) != VK_SUCCESS) {
+        return false;
+    }
+    
+    pipelineCacheStats.loadedFromDisk = !cacheData.empty();
+    pipelineCacheStats.loadedBytes = cacheData.size();
+    return true;
+}
+
+void VulkanRenderer::SavePipelineCache()
+{
+    if (pipelineCache == VK_NULL_HANDLE) {
+        return;
+    }
+    
+    size_t dataSize = 0;
+    std::vector<char> data;
+    if (vkGetPipelineCacheData(logicalDevice, pipelineCache, &dataSize, nullptr) == VK_SUCCESS && dataSize > 0) {
+        data.resize(dataSize);
+        if (vkGetPipelineCacheData(logicalDevice, pipelineCache, &dataSize, data.data()) != VK_SUCCESS) {
+            data.clear();
+        }
+        data.resize(dataSize);
+    }
+    vkDestroyPipelineCache(logicalDevice, pipelineCache, nullptr);
+    pipelineCache = VK_NULL_HANDLE;
+    
+    if (data.empty() || pipelineCachePath.empty()) {
+        return;
+    }
+    
+    // Write to a temporary file and rename it over the old cache, so a crash mid-write
+    // never leaves a truncated cache behind
+    std::string tempPath = pipelineCachePath + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), data.size());
+        if (!file.good()) {
+            std::cerr << "Failed to write pipeline cache " << tempPath << std::endl;
+            return;
+        }
+    }
+    
+#ifdef _WIN32
+    bool renamed = MoveFileExA(tempPath.c_str(), pipelineCachePath.c_str(),
+                               MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    bool renamed = std::rename(tempPath.c_str(), pipelineCachePath.c_str()) == 0;
+#endif
+    if (!renamed) {
+        std::cerr << "Failed to replace pipeline cache " << pipelineCachePath << std::endl;
+        std::remove(tempPath.c_str());
+        return;
+    }
+    pipelineCacheStats.savedBytes = data.size();
 }
 
 bool VulkanRenderer::CreateFramebuffers()
@@ -898,7 +2112,8 @@ bool VulkanRenderer::CreateCommandPool()
 
 bool VulkanRenderer::CreateCommandBuffers()
 {
-    commandBuffers.resize(swapchainFramebuffers.size());
+    // Recorded per frame slot, not per swapchain image
+    commandBuffers.resize(framesInFlight);
 
     VkCommandBufferAllocateInfo allocInfo{};
     allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
@@ -909,11 +2124,341 @@ bool VulkanRenderer::CreateCommandBuffers()
     return vkAllocateCommandBuffers(logicalDevice, &allocInfo, commandBuffers.data()) == VK_SUCCESS;
 }
 
+bool VulkanRenderer::CreateVertexRings()
+{
+    vertexRings.resize(inFlightFences.size());
+    
+    for (auto& ring : vertexRings) {
+        ring.buffer = VK_NULL_HANDLE;
+        ring.allocation = VulkanAllocation();
+        ring.mapped = nullptr;
+        ring.vertexCount = 0;
+        
+        try {
+            CreateBuffer(sizeof(VulkanVertex) * kMaxVerticesPerFrame, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         ring.buffer, ring.allocation);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return false;
+        }
+        
+        // The allocator keeps host-visible blocks mapped; coherent memory needs no explicit flush before submit
+        if (!ring.allocation.mapped) {
+            return false;
+        }
+        ring.mapped = static_cast<VulkanVertex*>(ring.allocation.mapped);
+    }
+    
+    spriteRings.resize(inFlightFences.size());
+    for (auto& ring : spriteRings) {
+        ring.buffer = VK_NULL_HANDLE;
+        ring.allocation = VulkanAllocation();
+        ring.mapped = nullptr;
+        ring.spriteCount = 0;
+        
+        try {
+            CreateBuffer(sizeof(VulkanSprite) * kMaxSpritesPerFrame, VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+                         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                         ring.buffer, ring.allocation);
+        } catch (const std::runtime_error& error) {
+            std::cerr << error.what() << std::endl;
+            return false;
+        }
+        
+        if (!ring.allocation.mapped) {
+            return false;
+        }
+        ring.mapped = static_cast<VulkanSprite*>(ring.allocation.mapped);
+    }
+    
+    return true;
+}
+
+void VulkanRenderer::DestroyVertexRings()
+{
+    for (auto& ring : vertexRings) {
+        DestroyBuffer(ring.buffer, ring.allocation);
+    }
+    vertexRings.clear();
+    for (auto& ring : spriteRings) {
+        DestroyBuffer(ring.buffer, ring.allocation);
+    }
+    spriteRings.clear();
+}
+
+bool VulkanRenderer::CreateRecordingContexts()
+{
+    QueueFamilyIndices queueFamilyIndices = FindQueueFamilies(physicalDevice);
+    
+    // Command pools are not thread safe, so each recording thread gets one per frame in flight
+    recordingContexts.resize(inFlightFences.size());
+    for (auto& frameContexts : recordingContexts) {
+        frameContexts.resize(recordingWorkers.GetThreadCount());
+        for (auto& context : frameContexts) {
+            context.commandPool = VK_NULL_HANDLE;
+            context.usedBuffers = 0;
+            
+            VkCommandPoolCreateInfo poolInfo{};
+            poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+            poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+            poolInfo.queueFamilyIndex = queueFamilyIndices.graphicsFamily.value();
+            if (vkCreateCommandPool(logicalDevice, &poolInfo, nullptr, &context.commandPool) != VK_SUCCESS) {
+                return false;
+            }
+        }
+    }
+    
+    return true;
+}
+
+void VulkanRenderer::DestroyRecordingContexts()
+{
+    for (auto& frameContexts : recordingContexts) {
+        for (auto& context : frameContexts) {
+            if (context.commandPool != VK_NULL_HANDLE) {
+                vkDestroyCommandPool(logicalDevice, context.commandPool, nullptr);
+            }
+        }
+    }
+    recordingContexts.clear();
+}
+
+VkCommandBuffer VulkanRenderer::AcquireSecondaryCommandBuffer(uint32_t threadIndex)
+{
+    RecordingThreadContext& context = recordingContexts[currentFrame][threadIndex];
+    
+    if (context.usedBuffers == context.secondaryBuffers.size()) {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = context.commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+        allocInfo.commandBufferCount = 1;
+        
+        VkCommandBuffer commandBuffer;
+        if (vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            return VK_NULL_HANDLE;
+        }
+        context.secondaryBuffers.push_back(commandBuffer);
+    }
+    VkCommandBuffer commandBuffer = context.secondaryBuffers[context.usedBuffers++];
+    
+    VkCommandBufferInheritanceInfo inheritanceInfo{};
+    inheritanceInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+    inheritanceInfo.renderPass = loadRenderPass;
+    inheritanceInfo.subpass = 0;
+    inheritanceInfo.framebuffer = swapchainFramebuffers[currentImageIndex];
+    
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    beginInfo.pInheritanceInfo = &inheritanceInfo;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        return VK_NULL_HANDLE;
+    }
+    
+    // Dynamic state and bindings are not inherited from the primary command buffer
+    SetViewportAndScissor(commandBuffer);
+    BindFrameBuffers(commandBuffer);
+    BindTextureDescriptors(commandBuffer);
+    return commandBuffer;
+}
+
+void VulkanRenderer::BeginRenderPassInstance(VkRenderPass pass, VkSubpassContents contents)
+{
+    VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+    
+    VkRenderPassBeginInfo renderPassInfo{};
+    renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+    renderPassInfo.renderPass = pass;
+    renderPassInfo.framebuffer = swapchainFramebuffers[currentImageIndex];
+    renderPassInfo.renderArea.offset = {0, 0};
+    renderPassInfo.renderArea.extent = swapchainExtent;
+    
+    VkClearValue clearColorValue;
+    clearColorValue.color.float32[0] = this->clearColor[0];
+    clearColorValue.color.float32[1] = this->clearColor[1];
+    clearColorValue.color.float32[2] = this->clearColor[2];
+    clearColorValue.color.float32[3] = this->clearColor[3];
+    
+    renderPassInfo.clearValueCount = 1;
+    renderPassInfo.pClearValues = &clearColorValue;
+    
+    vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, contents);
+    
+    if (contents == VK_SUBPASS_CONTENTS_INLINE) {
+        SetViewportAndScissor(commandBuffer);
+        
+        BindFrameBuffers(commandBuffer);
+        BindTextureDescriptors(commandBuffer);
+    }
+}
+
+void VulkanRenderer::SetViewportAndScissor(VkCommandBuffer commandBuffer)
+{
+    // Viewport and scissor are dynamic so pipelines survive a swapchain resize
+    VkViewport viewport{};
+    viewport.x = 0.0f;
+    viewport.y = 0.0f;
+    viewport.width = (float)swapchainExtent.width;
+    viewport.height = (float)swapchainExtent.height;
+    viewport.minDepth = 0.0f;
+    viewport.maxDepth = 1.0f;
+    vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+    
+    VkRect2D scissor{};
+    scissor.offset = {0, 0};
+    scissor.extent = swapchainExtent;
+    vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+}
+
+VulkanVertex* VulkanRenderer::AllocateVertices(uint32_t count)
+{
+    if (!frameInProgress) {
+        return nullptr;
+    }
+    
+    FrameVertexRing& ring = vertexRings[currentFrame];
+    if (ring.vertexCount + count > kMaxVerticesPerFrame) {
+        if (!vertexRingOverflowed) {
+            std::cerr << "Vulkan vertex ring full, dropping shapes for the rest of the frame" << std::endl;
+            vertexRingOverflowed = true;
+        }
+        return nullptr;
+    }
+    
+    // Sprites drawn before this shape must be drawn before it
+    if (spriteBatchCount > 0) {
+        FlushSpriteBatch();
+    }
+    
+    // A pipeline change ends the current draw; otherwise the shape extends it
+    if (activePipeline != batchPipeline) {
+        FlushDrawBatch();
+        batchPipeline = activePipeline;
+    }
+    
+    VulkanVertex* vertices = ring.mapped + ring.vertexCount;
+    ring.vertexCount += count;
+    batchVertexCount += count;
+    return vertices;
+}
+
+void VulkanRenderer::FlushDrawBatch()
+{
+    if (batchVertexCount > 0 && batchPipeline != VK_NULL_HANDLE) {
+        VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+        if (boundPipeline != batchPipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, batchPipeline);
+            boundPipeline = batchPipeline;
+        }
+        vkCmdDraw(commandBuffer, batchVertexCount, 1, batchFirstVertex, 0);
+    }
+    
+    batchFirstVertex = vertexRings.empty() ? 0 : vertexRings[currentFrame].vertexCount;
+    batchVertexCount = 0;
+    
+    FlushSpriteBatch();
+}
+
+VulkanSprite* VulkanRenderer::AllocateSprites(uint32_t count)
+{
+    if (!frameInProgress) {
+        return nullptr;
+    }
+    
+    FrameSpriteRing& ring = spriteRings[currentFrame];
+    if (ring.spriteCount + count > kMaxSpritesPerFrame) {
+        if (!spriteRingOverflowed) {
+            std::cerr << "Vulkan sprite ring full, dropping sprites for the rest of the frame" << std::endl;
+            spriteRingOverflowed = true;
+        }
+        return nullptr;
+    }
+    
+    // Shapes drawn before these sprites must be drawn before them
+    if (batchVertexCount > 0) {
+        FlushDrawBatch();
+    }
+    
+    VulkanSprite* sprites = ring.mapped + ring.spriteCount;
+    ring.spriteCount += count;
+    spriteBatchCount += count;
+    return sprites;
+}
+
+void VulkanRenderer::FlushSpriteBatch()
+{
+    if (spriteBatchCount > 0) {
+        VkCommandBuffer commandBuffer = commandBuffers[currentFrame];
+        if (boundPipeline != spritePipeline) {
+            vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, spritePipeline);
+            boundPipeline = spritePipeline;
+        }
+        // Six corners per instance, every sprite of the batch in one draw
+        vkCmdDraw(commandBuffer, 6, spriteBatchCount, 0, spriteBatchFirst);
+    }
+    
+    spriteBatchFirst = spriteRings.empty() ? 0 : spriteRings[currentFrame].spriteCount;
+    spriteBatchCount = 0;
+}
+
+void VulkanRenderer::UpdateSpriteView()
+{
+    // Pixel coordinates with a top-left origin to clip space, after the camera matrix
+    float pixelToClip[16] = {};
+    pixelToClip[0] = 2.0f / (float)swapchainExtent.width;
+    pixelToClip[5] = 2.0f / (float)swapchainExtent.height;
+    pixelToClip[10] = 1.0f;
+    pixelToClip[12] = -1.0f;
+    pixelToClip[13] = -1.0f;
+    pixelToClip[15] = 1.0f;
+    
+    for (int column = 0; column < 4; column++) {
+        for (int row = 0; row < 4; row++) {
+            float sum = 0.0f;
+            for (int k = 0; k < 4; k++) {
+                sum += pixelToClip[k * 4 + row] * viewMatrix[column * 4 + k];
+            }
+            spriteView.view[column * 4 + row] = sum;
+        }
+    }
+}
+
+void VulkanRenderer::WriteVertex(VulkanVertex& vertex, float x, float y, float u, float v)
+{
+    TransformVertex(vertex, x, y, u, v, transform, drawColor, currentTextureIndex, swapchainExtent);
+}
+
+const std::vector<float>& VulkanRenderer::GetUnitCircle(int segments)
+{
+    // Layer recorders call this from worker threads; map nodes stay put, so the reference outlives the lock
+    std::lock_guard<std::mutex> lock(unitCircleMutex);
+    auto it = unitCircles.find(segments);
+    if (it != unitCircles.end()) {
+        return it->second;
+    }
+    
+    // segments + 1 points so the last triangle closes the circle
+    std::vector<float> points;
+    points.reserve((segments + 1) * 2);
+    for (int i = 0; i <= segments; i++) {
+        float angle = 2.0f * kPi * i / segments;
+        points.push_back(cosf(angle));
+        points.push_back(sinf(angle));
+    }
+    
+    return unitCircles.emplace(segments, std::move(points)).first->second;
+}
+
 bool VulkanRenderer::CreateSyncObjects()
 {
-    imageAvailableSemaphores.resize(2);
-    renderFinishedSemaphores.resize(2);
-    inFlightFences.resize(2);
+    imageAvailableSemaphores.resize(framesInFlight);
+    renderFinishedSemaphores.resize(framesInFlight);
+    inFlightFences.resize(framesInFlight);
+    imagesInFlight.assign(swapchainImages.size(), VK_NULL_HANDLE);
+    frameTimingStats.framesInFlight = framesInFlight;
+    ResetFrameTimingStats();
 
     VkSemaphoreCreateInfo semaphoreInfo{};
     semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
@@ -922,7 +2467,7 @@ bool VulkanRenderer::CreateSyncObjects()
     fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
     fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
 
-    for (size_t i = 0; i < 2; i++) {
+    for (size_t i = 0; i < framesInFlight; i++) {
         if (vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &imageAvailableSemaphores[i]) != VK_SUCCESS ||
             vkCreateSemaphore(logicalDevice, &semaphoreInfo, nullptr, &renderFinishedSemaphores[i]) != VK_SUCCESS ||
             vkCreateFence(logicalDevice, &fenceInfo, nullptr, &inFlightFences[i]) != VK_SUCCESS) {
@@ -947,12 +2492,21 @@ VkSurfaceFormatKHR VulkanRenderer::ChooseSwapSurfaceFormat(const std::vector<VkS
 
 VkPresentModeKHR VulkanRenderer::ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes)
 {
+    VkPresentModeKHR preferred = VK_PRESENT_MODE_FIFO_KHR;
+    if (requestedPresentMode == VulkanPresentMode::Mailbox) {
+        preferred = VK_PRESENT_MODE_MAILBOX_KHR;
+    } else if (requestedPresentMode == VulkanPresentMode::Immediate) {
+        preferred = VK_PRESENT_MODE_IMMEDIATE_KHR;
+    }
+
     for (const auto& availablePresentMode : availablePresentModes) {
-        if (availablePresentMode == VK_PRESENT_MODE_MAILBOX_KHR) {
+        if (availablePresentMode == preferred) {
+            frameTimingStats.presentMode = requestedPresentMode;
             return availablePresentMode;
         }
     }
 
+    frameTimingStats.presentMode = VulkanPresentMode::Fifo;
     return VK_PRESENT_MODE_FIFO_KHR;
 }
 
@@ -961,7 +2515,8 @@ VkExtent2D VulkanRenderer::ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capa
     if (capabilities.currentExtent.width != UINT32_MAX) {
         return capabilities.currentExtent;
     } else {
-        VkExtent2D actualExtent = {800, 600}; // Default window size
+        // The surface lets the application pick, so use the size given to SetSurface
+        VkExtent2D actualExtent = {surfaceWidth, surfaceHeight};
 
         actualExtent.width = std::max(capabilities.minImageExtent.width,
                                       std::min(capabilities.maxImageExtent.width, actualExtent.width));
@@ -985,24 +2540,36 @@ QueueFamilyIndices VulkanRenderer::FindQueueFamilies(VkPhysicalDevice device)
 
     int i = 0;
     for (const auto& queueFamily : queueFamilies) {
-        if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+        if ((queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) && !indices.graphicsFamily.has_value()) {
             indices.graphicsFamily = i;
         }
 
+        // Offscreen frames are never presented, so graphics doubles as the present family
         VkBool32 presentSupport = false;
-        vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        if (offscreen) {
+            presentSupport = (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
+        } else {
+            vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, &presentSupport);
+        }
 
-        if (presentSupport) {
+        if (presentSupport && !indices.presentFamily.has_value()) {
             indices.presentFamily = i;
         }
 
-        if (indices.IsComplete()) {
-            break;
+        // A transfer-only family maps to the copy engine and runs beside graphics work
+        if ((queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT) &&
+            !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT)) &&
+            !indices.transferFamily.has_value()) {
+            indices.transferFamily = i;
         }
 
         i++;
     }
 
+    if (!indices.transferFamily.has_value()) {
+        indices.transferFamily = indices.graphicsFamily;
+    }
+
     return indices;
 }
 
@@ -1037,38 +2604,55 @@ bool VulkanRenderer::IsDeviceSuitable(VkPhysicalDevice device)
 
     bool extensionsSupported = true; // Simplified check
 
-    bool swapChainAdequate = false;
-    if (extensionsSupported) {
+    // Uploads are tracked with timeline semaphores and textures are bindless (both core in Vulkan 1.2)
+    VkPhysicalDeviceProperties properties;
+    vkGetPhysicalDeviceProperties(device, &properties);
+
+    VkPhysicalDeviceVulkan12Features vulkan12Features{};
+    vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+    VkPhysicalDeviceFeatures2 features{};
+    features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+    features.pNext = &vulkan12Features;
+    if (properties.apiVersion >= VK_API_VERSION_1_2) {
+        vkGetPhysicalDeviceFeatures2(device, &features);
+    }
+    bool featuresSupported = vulkan12Features.timelineSemaphore == VK_TRUE &&
+                             vulkan12Features.runtimeDescriptorArray == VK_TRUE &&
+                             vulkan12Features.descriptorBindingPartiallyBound == VK_TRUE &&
+                             vulkan12Features.descriptorBindingSampledImageUpdateAfterBind == VK_TRUE &&
+                             vulkan12Features.shaderSampledImageArrayNonUniformIndexing == VK_TRUE;
+
+    bool swapChainAdequate = offscreen;
+    if (extensionsSupported && !offscreen) {
         SwapChainSupportDetails swapChainSupport = QuerySwapChainSupport(device);
         swapChainAdequate = !swapChainSupport.formats.empty() && !swapChainSupport.presentModes.empty();
     }
 
-    return indices.IsComplete() && extensionsSupported && swapChainAdequate;
+    return indices.IsComplete() && extensionsSupported && swapChainAdequate && featuresSupported;
 }
 
 uint32_t VulkanRenderer::FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties)
 {
-    VkPhysicalDeviceMemoryProperties memProperties;
-    vkGetPhysicalDeviceMemoryProperties(physicalDevice, &memProperties);
-
-    for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
-        if ((typeFilter & (1 << i)) && (memProperties.memoryTypes[i].propertyFlags & properties) == properties) {
-            return i;
-        }
+    uint32_t memoryType = memoryAllocator.FindMemoryType(typeFilter, properties);
+    if (memoryType == UINT32_MAX) {
+        throw std::runtime_error("Failed to find suitable memory type!");
     }
-    
-    throw std::runtime_error("Failed to find suitable memory type!");
+    return memoryType;
 }
 
 void VulkanRenderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
-                                 VkBuffer& buffer, VkDeviceMemory& bufferMemory)
+                                 VkBuffer& buffer, VulkanAllocation& allocation)
 {
     // Create buffer
     VkBufferCreateInfo bufferInfo{};
     bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
     bufferInfo.size = size;
     bufferInfo.usage = usage;
-    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    uint32_t queueFamilies[2];
+    uint32_t queueFamilyCount = 0;
+    bufferInfo.sharingMode = GetResourceSharing(queueFamilies, queueFamilyCount);
+    bufferInfo.queueFamilyIndexCount = queueFamilyCount;
+    bufferInfo.pQueueFamilyIndices = queueFamilies;
 
     if (vkCreateBuffer(logicalDevice, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
         throw std::runtime_error("Failed to create buffer!");
@@ -1078,61 +2662,51 @@ void VulkanRenderer::CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, V
     VkMemoryRequirements memRequirements;
     vkGetBufferMemoryRequirements(logicalDevice, buffer, &memRequirements);
 
-    // Find memory type
-    VkMemoryAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
-    allocInfo.allocationSize = memRequirements.size;
-    allocInfo.memoryTypeIndex = FindMemoryType(memRequirements.memoryTypeBits, properties);
-
-    // Allocate memory
-    if (vkAllocateMemory(logicalDevice, &allocInfo, nullptr, &bufferMemory) != VK_SUCCESS) {
+    // Sub-allocate from a shared block instead of one vkAllocateMemory per buffer
+    if (!memoryAllocator.Allocate(memRequirements, properties, VulkanResourceKind::Linear, allocation)) {
+        vkDestroyBuffer(logicalDevice, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
         throw std::runtime_error("Failed to allocate buffer memory!");
     }
 
-    // Bind buffer to memory
-    vkBindBufferMemory(logicalDevice, buffer, bufferMemory, 0);
+    // Bind buffer to its range of the block
+    vkBindBufferMemory(logicalDevice, buffer, allocation.memory, allocation.offset);
 }
 
-void VulkanRenderer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+void VulkanRenderer::DestroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation)
 {
-    // Create a temporary command buffer for the copy operation
-    VkCommandBufferAllocateInfo allocInfo{};
-    allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
-    allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
-    allocInfo.commandPool = commandPool;
-    allocInfo.commandBufferCount = 1;
-
-    VkCommandBuffer commandBuffer;
-    vkAllocateCommandBuffers(logicalDevice, &allocInfo, &commandBuffer);
-
-    // Begin recording the command buffer
-    VkCommandBufferBeginInfo beginInfo{};
-    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
-    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
-
-    vkBeginCommandBuffer(commandBuffer, &beginInfo);
-
-    // Add the copy command
-    VkBufferCopy copyRegion{};
-    copyRegion.srcOffset = 0;
-    copyRegion.dstOffset = 0;
-    copyRegion.size = size;
-    vkCmdCopyBuffer(commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
-
-    // End recording
-    vkEndCommandBuffer(commandBuffer);
+    if (buffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(logicalDevice, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+    }
+    memoryAllocator.Free(allocation);
+}
 
-    // Submit the command buffer
-    VkSubmitInfo submitInfo{};
-    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
-    submitInfo.commandBufferCount = 1;
-    submitInfo.pCommandBuffers = &commandBuffer;
+VkSharingMode VulkanRenderer::GetResourceSharing(uint32_t* queueFamilies, uint32_t& queueFamilyCount) const
+{
+    // Resources written on the transfer queue and read on the graphics queue are shared
+    // concurrently, which avoids queue family ownership transfers
+    if (transferQueueFamily == graphicsQueueFamily) {
+        queueFamilyCount = 0;
+        return VK_SHARING_MODE_EXCLUSIVE;
+    }
+    queueFamilies[0] = graphicsQueueFamily;
+    queueFamilies[1] = transferQueueFamily;
+    queueFamilyCount = 2;
+    return VK_SHARING_MODE_CONCURRENT;
+}
 
-    vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE);
-    vkQueueWaitIdle(graphicsQueue);
+VulkanAllocatorStats VulkanRenderer::GetMemoryStats() const
+{
+    return memoryAllocator.GetStats();
+}
 
-    // Clean up the temporary command buffer
-    vkFreeCommandBuffers(logicalDevice, commandPool, 1, &commandBuffer);
+void VulkanRenderer::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+{
+    // Batched with other uploads and submitted at the end of the frame; no queue drain
+    if (!stagingRing.CopyBuffer(srcBuffer, dstBuffer, size)) {
+        throw std::runtime_error("Failed to record buffer copy!");
+    }
 }
 
 std::vector<char> VulkanRenderer::ReadShaderFile(const std::string& filename)
@@ -1167,4 +2741,187 @@ VkShaderModule VulkanRenderer::CreateShaderModule(const std::vector<char>& code)
     }
     
     return shaderModule;
-}
\ No newline at end of file
+}
+VulkanLayerRecorder::VulkanLayerRecorder(VulkanRenderer* owner, VkCommandBuffer layerCommandBuffer)
+    : renderer(owner), commandBuffer(layerCommandBuffer), shapePipeline(owner->activePipeline),
+      boundPipeline(VK_NULL_HANDLE), ringVertices(owner->vertexRings[owner->currentFrame].mapped),
+      ringSprites(owner->spriteRings[owner->currentFrame].mapped),
+      textureIndex(owner->currentTextureIndex), drawFirstVertex(0), drawVertexCount(0), chunkEnd(0),
+      spriteFirst(0), spriteCount(0), spriteChunkEnd(0)
+{
+    for (int i = 0; i < 4; i++) {
+        transform[i] = owner->transform[i];
+        drawColor[i] = owner->drawColor[i];
+    }
+}
+
+void VulkanLayerRecorder::SetDrawColor(float r, float g, float b, float a)
+{
+    drawColor[0] = r;
+    drawColor[1] = g;
+    drawColor[2] = b;
+    drawColor[3] = a;
+}
+
+void VulkanLayerRecorder::UseTexture(unsigned int textureId)
+{
+    textureIndex = renderer->GetTextureIndex(textureId);
+}
+
+void VulkanLayerRecorder::SetTransform(float x, float y, float rotation, float scale)
+{
+    transform[0] = x;
+    transform[1] = y;
+    transform[2] = rotation;
+    transform[3] = scale;
+}
+
+void VulkanLayerRecorder::DrawQuad(float x, float y, float width, float height)
+{
+    VulkanVertex* vertices = AllocateVertices(6);
+    if (!vertices) {
+        return;
+    }
+    
+    WriteVertex(vertices[0], x, y, 0.0f, 0.0f);
+    WriteVertex(vertices[1], x + width, y, 1.0f, 0.0f);
+    WriteVertex(vertices[2], x + width, y + height, 1.0f, 1.0f);
+    vertices[3] = vertices[0];
+    vertices[4] = vertices[2];
+    WriteVertex(vertices[5], x, y + height, 0.0f, 1.0f);
+}
+
+void VulkanLayerRecorder::DrawTriangle(float x1, float y1, float x2, float y2, float x3, float y3)
+{
+    VulkanVertex* vertices = AllocateVertices(3);
+    if (!vertices) {
+        return;
+    }
+    
+    WriteVertex(vertices[0], x1, y1, 0.0f, 0.0f);
+    WriteVertex(vertices[1], x2, y2, 1.0f, 0.0f);
+    WriteVertex(vertices[2], x3, y3, 0.0f, 1.0f);
+}
+
+void VulkanLayerRecorder::DrawCircle(float centerX, float centerY, float radius, int segments)
+{
+    segments = std::max(segments, 3);
+    
+    VulkanVertex* vertices = AllocateVertices(static_cast<uint32_t>(segments) * 3);
+    if (!vertices) {
+        return;
+    }
+    
+    const std::vector<float>& unitCircle = renderer->GetUnitCircle(segments);
+    VulkanVertex center;
+    WriteVertex(center, centerX, centerY, 0.5f, 0.5f);
+    
+    for (int i = 0; i < segments; i++) {
+        vertices[i * 3] = center;
+        const float* edge = &unitCircle[i * 2];
+        WriteVertex(vertices[i * 3 + 1], centerX + edge[0] * radius, centerY + edge[1] * radius,
+                    0.5f + edge[0] * 0.5f, 0.5f + edge[1] * 0.5f);
+        WriteVertex(vertices[i * 3 + 2], centerX + edge[2] * radius, centerY + edge[3] * radius,
+                    0.5f + edge[2] * 0.5f, 0.5f + edge[3] * 0.5f);
+    }
+}
+
+void VulkanLayerRecorder::DrawSprite(float x, float y, float width, float height, float rotation)
+{
+    // Sprites follow any shapes recorded before them
+    FlushDraw();
+    
+    // Same chunked reservation as the vertex ring
+    uint32_t next = spriteFirst + spriteCount;
+    if (next + 1 > spriteChunkEnd) {
+        FlushSprites();
+        uint32_t start = renderer->layerSpriteCount.fetch_add(kChunkSprites);
+        if (start + 1 > VulkanRenderer::kMaxSpritesPerFrame) {
+            renderer->layerRingOverflowed.store(true);
+            spriteChunkEnd = 0;
+            spriteFirst = 0;
+            return;
+        }
+        spriteChunkEnd = std::min(start + kChunkSprites, VulkanRenderer::kMaxSpritesPerFrame);
+        spriteFirst = start;
+        next = start;
+    }
+    spriteCount++;
+    
+    VulkanSprite& sprite = ringSprites[next];
+    sprite.position[0] = x + width * 0.5f;
+    sprite.position[1] = y + height * 0.5f;
+    sprite.size[0] = width;
+    sprite.size[1] = height;
+    sprite.uvRect[0] = 0.0f;
+    sprite.uvRect[1] = 0.0f;
+    sprite.uvRect[2] = 1.0f;
+    sprite.uvRect[3] = 1.0f;
+    for (int i = 0; i < 4; i++) {
+        sprite.color[i] = drawColor[i];
+    }
+    sprite.rotation = rotation;
+    sprite.textureId = textureIndex;
+}
+
+VulkanVertex* VulkanLayerRecorder::AllocateVertices(uint32_t count)
+{
+    // Shapes follow any sprites recorded before them
+    FlushSprites();
+    
+    uint32_t next = drawFirstVertex + drawVertexCount;
+    
+    // Reserve ring space in chunks so recorders rarely touch the shared counter
+    // and each chunk stays one draw call
+    if (next + count > chunkEnd) {
+        FlushDraw();
+        
+        uint32_t chunkSize = std::max(count, kChunkVertices);
+        uint32_t start = renderer->layerVertexCount.fetch_add(chunkSize);
+        if (start + count > VulkanRenderer::kMaxVerticesPerFrame) {
+            renderer->layerRingOverflowed.store(true);
+            chunkEnd = 0;
+            drawFirstVertex = 0;
+            return nullptr;
+        }
+        chunkEnd = std::min(start + chunkSize, VulkanRenderer::kMaxVerticesPerFrame);
+        drawFirstVertex = start;
+        next = start;
+    }
+    
+    drawVertexCount += count;
+    return ringVertices + next;
+}
+
+void VulkanLayerRecorder::FlushDraw()
+{
+    if (drawVertexCount > 0) {
+        BindPipeline(shapePipeline);
+        vkCmdDraw(commandBuffer, drawVertexCount, 1, drawFirstVertex, 0);
+    }
+    drawFirstVertex += drawVertexCount;
+    drawVertexCount = 0;
+}
+
+void VulkanLayerRecorder::FlushSprites()
+{
+    if (spriteCount > 0) {
+        BindPipeline(renderer->spritePipeline);
+        vkCmdDraw(commandBuffer, 6, spriteCount, 0, spriteFirst);
+    }
+    spriteFirst += spriteCount;
+    spriteCount = 0;
+}
+
+void VulkanLayerRecorder::BindPipeline(VkPipeline pipeline)
+{
+    if (boundPipeline != pipeline) {
+        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline);
+        boundPipeline = pipeline;
+    }
+}
+
+void VulkanLayerRecorder::WriteVertex(VulkanVertex& vertex, float x, float y, float u, float v)
+{
+    TransformVertex(vertex, x, y, u, v, transform, drawColor, textureIndex, renderer->swapchainExtent);
+}
@@ -1,10 +1,23 @@
 #pragma once
+#ifdef _WIN32
+#define VK_USE_PLATFORM_WIN32_KHR
+#endif
 #include "IRenderer.h"
+#include "VulkanGpuTimer.h"
+#include "VulkanMemoryAllocator.h"
+#include "VulkanStagingRing.h"
+#include "WorkerPool.h"
 #include <vulkan/vulkan.h>
 #include <vector>
 #include <unordered_map>
 #include <optional>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <fstream>
 #include <iostream>
 
@@ -12,6 +25,7 @@
 struct QueueFamilyIndices {
     std::optional<uint32_t> graphicsFamily;
     std::optional<uint32_t> presentFamily;
+    std::optional<uint32_t> transferFamily; // dedicated transfer family, else the graphics family
 
     bool IsComplete() {
         return graphicsFamily.has_value() && presentFamily.has_value();
@@ -24,6 +38,179 @@ struct SwapChainSupportDetails {
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+// Vertex layout shared by the built-in pipeline and pipelines created by LoadShader
+struct VulkanVertex {
+    float position[2]; // normalized device coordinates
+    float color[4];
+    float uv[2];
+    uint32_t textureIndex; // element of the bindless texture array, 0 is plain white
+};
+
+// Per-instance data of the sprite pipeline (vertex binding 1, one instance per sprite)
+struct VulkanSprite {
+    float position[2];     // center in pixels, top-left origin
+    float size[2];         // width and height in pixels
+    float uvRect[4];       // u0, v0, u1, v1
+    float color[4];
+    float rotation;        // degrees around the center, same direction as SetTransform
+    uint32_t textureId;    // LoadTexture ID, 0 is plain white
+    float padding[2];
+};
+
+// Push constants shared by every pipeline layout, so binding any pipeline keeps them valid
+struct VulkanViewPushConstants {
+    float view[16];        // column-major; maps sprite pixel coordinates to clip space
+};
+
+// Sampled image created by LoadTexture
+struct VulkanTexture {
+    VkImage image;
+    VkImageView view;
+    VulkanAllocation allocation;
+    uint32_t width;
+    uint32_t height;
+};
+
+// Color target rendered to instead of a swapchain image in offscreen mode
+struct OffscreenTarget {
+    VkImage image;
+    VulkanAllocation allocation;
+    VkBuffer readbackBuffer;        // tightly packed RGBA8 copy of the finished frame
+    VulkanAllocation readbackAllocation;
+};
+
+// Swapchain objects replaced by a resize; destroyed once no frame in flight can still use them
+struct RetiredSwapchain {
+    VkSwapchainKHR swapchain;
+    std::vector<VkImageView> imageViews;
+    std::vector<VkFramebuffer> framebuffers;
+    uint64_t retiredAtFrame;        // frames submitted when it was replaced
+};
+
+// Host-visible vertex buffer that one frame in flight appends its geometry to
+struct FrameVertexRing {
+    VkBuffer buffer;
+    VulkanAllocation allocation;
+    VulkanVertex* mapped;
+    uint32_t vertexCount;
+};
+
+// Host-visible instance buffer that one frame in flight appends its sprites to
+struct FrameSpriteRing {
+    VkBuffer buffer;
+    VulkanAllocation allocation;
+    VulkanSprite* mapped;
+    uint32_t spriteCount;
+};
+
+// Pipeline cache effectiveness, compare a cold run (no cache file) against a warm one
+struct VulkanPipelineCacheStats {
+    bool loadedFromDisk = false;    // a valid cache file for this device was found
+    size_t loadedBytes = 0;
+    size_t savedBytes = 0;
+    uint32_t pipelinesCreated = 0;
+    double pipelineCreateMs = 0.0;  // total time spent in vkCreateGraphicsPipelines
+    double initializeMs = 0.0;      // wall time of Initialize
+};
+
+// CPU time of the last RecordLayers call, for comparing recording thread counts
+struct VulkanRecordingStats {
+    uint32_t threadCount = 0;
+    uint32_t layerCount = 0;
+    double recordMs = 0.0;
+};
+
+// Progress of a LoadShader pipeline compile
+enum class VulkanShaderStatus {
+    Unknown,     // no such shader ID
+    Compiling,   // draws with the shader use the built-in pipeline until it is ready
+    Ready,
+    Failed       // the shader keeps drawing with the built-in pipeline
+};
+
+// A LoadShader request handed to the pipeline compile threads
+struct PipelineCompileJob {
+    unsigned int shaderId;
+    std::string vertexShaderFile;
+    std::string fragmentShaderFile;
+    VkShaderModule vertShaderModule = VK_NULL_HANDLE;
+    VkShaderModule fragShaderModule = VK_NULL_HANDLE;
+    VkPipelineLayout layout = VK_NULL_HANDLE;
+    VkPipeline pipeline = VK_NULL_HANDLE;
+};
+
+// Present mode preference; unsupported modes fall back to FIFO, which every device supports
+enum class VulkanPresentMode {
+    Fifo,        // vsync, frames queue up behind the display (highest latency, never tears)
+    Mailbox,     // vsync, the newest frame replaces a queued one (low latency, never tears)
+    Immediate    // no vsync (lowest latency, may tear)
+};
+
+// CPU time BeginFrame spends blocked, for tuning frames in flight and the present mode
+struct VulkanFrameTimingStats {
+    uint32_t framesInFlight = 0;
+    VulkanPresentMode presentMode = VulkanPresentMode::Fifo;   // mode actually in use
+    uint64_t frameCount = 0;
+    double lastFenceWaitMs = 0.0;   // waiting for the frame slot (and its swapchain image) to retire
+    double lastAcquireMs = 0.0;     // vkAcquireNextImageKHR
+    double totalFenceWaitMs = 0.0;
+    double totalAcquireMs = 0.0;
+    double maxFenceWaitMs = 0.0;
+    double maxAcquireMs = 0.0;
+};
+
+// Per recording thread and frame in flight; the pool is reset once the frame's fence has signaled
+struct RecordingThreadContext {
+    VkCommandPool commandPool;
+    std::vector<VkCommandBuffer> secondaryBuffers;
+    uint32_t usedBuffers;
+};
+
+class VulkanRenderer;
+
+// Records one layer into its own secondary command buffer. Each recorder is used by a single
+// thread; its color and transform start from the renderer's state when RecordLayers was called.
+class VulkanLayerRecorder
+{
+public:
+    void SetDrawColor(float r, float g, float b, float a = 1.0f);
+    void UseTexture(unsigned int textureId);
+    void SetTransform(float x, float y, float rotation, float scale = 1.0f);
+    void DrawQuad(float x, float y, float width, float height);
+    void DrawTriangle(float x1, float y1, float x2, float y2, float x3, float y3);
+    void DrawCircle(float centerX, float centerY, float radius, int segments = 32);
+    // Instanced; consecutive sprites of a layer share one draw
+    void DrawSprite(float x, float y, float width, float height, float rotation = 0.0f);
+
+private:
+    friend class VulkanRenderer;
+    static constexpr uint32_t kChunkVertices = 1024;
+    static constexpr uint32_t kChunkSprites = 256;
+
+    VulkanLayerRecorder(VulkanRenderer* renderer, VkCommandBuffer commandBuffer);
+    VulkanVertex* AllocateVertices(uint32_t count);
+    void FlushDraw();
+    void FlushSprites();
+    void BindPipeline(VkPipeline pipeline);
+    void WriteVertex(VulkanVertex& vertex, float x, float y, float u, float v);
+
+    VulkanRenderer* renderer;
+    VkCommandBuffer commandBuffer;
+    VkPipeline shapePipeline;
+    VkPipeline boundPipeline;
+    VulkanVertex* ringVertices;
+    VulkanSprite* ringSprites;
+    float transform[4];
+    float drawColor[4];
+    uint32_t textureIndex;
+    uint32_t drawFirstVertex;   // range of the draw being accumulated
+    uint32_t drawVertexCount;
+    uint32_t chunkEnd;          // end of the ring chunk this recorder reserved
+    uint32_t spriteFirst;       // same for sprites
+    uint32_t spriteCount;
+    uint32_t spriteChunkEnd;
+};
+
 class VulkanRenderer : public IRenderer
 {
 public:
@@ -31,6 +218,9 @@ public:
     virtual ~VulkanRenderer();
 
     // IRenderer interface implementation
+    // LoadShader returns at once; the pipeline is compiled on a background thread (see GetShaderStatus)
+    // A null hwnd starts offscreen mode: frames go to device images of the SetSurface size
+    // and are read back with ReadbackFrame, so no window system is needed
     virtual bool Initialize(HWND hwnd) override;
     virtual void Cleanup() override;
     virtual void BeginFrame() override;
@@ -46,13 +236,76 @@ public:
     virtual void UseShader(unsigned int shaderId) override;
     virtual void SetSurface(unsigned int width, unsigned int height) override;
 
+    // Color used for subsequently drawn shapes
+    void SetDrawColor(float r, float g, float b, float a = 1.0f);
+
+    // Directory the built-in SPIR-V shaders are loaded from (call before Initialize)
+    void SetShaderDirectory(const std::string& directory);
+
+    // Draws a sprite with the instanced sprite pipeline, using the current texture and draw color.
+    // Unlike shapes it is not affected by SetTransform; consecutive sprites share one draw.
+    void DrawSprite(float x, float y, float width, float height, float rotation = 0.0f);
+    // Copies a whole layer of sprites into the frame's instance buffer and draws it with one vkCmdDraw
+    void DrawSpriteLayer(const VulkanSprite* sprites, uint32_t count);
+    // Column-major camera matrix applied to sprite positions before the pixel-to-clip mapping
+    // (nullptr restores identity). Pushed as a push constant with each sprite draw.
+    void SetViewMatrix(const float* matrix);
+
+    // GPU timing: named scopes inside a frame, read back a few frames later without stalling
+    void BeginGpuScope(const char* name);
+    void EndGpuScope();
+    bool GetLastGpuFrameTiming(GpuFrameTiming& timing) const;
+
+    // Whether the pipeline of a LoadShader ID has finished compiling. Finished pipelines
+    // are picked up at BeginFrame or by this call.
+    VulkanShaderStatus GetShaderStatus(unsigned int shaderId);
+    bool IsShaderReady(unsigned int shaderId) { return GetShaderStatus(shaderId) == VulkanShaderStatus::Ready; }
+    // Blocks until every LoadShader so far has finished compiling, e.g. behind a loading screen
+    void WaitForShaders();
+
+    // Frames the CPU may record ahead of the GPU, 1 to 4 (call before Initialize).
+    // Fewer frames lower input latency, more frames hide CPU/GPU stalls.
+    bool SetFramesInFlight(uint32_t count);
+    // Preferred swapchain present mode (call before Initialize)
+    void SetPresentMode(VulkanPresentMode mode);
+    const VulkanFrameTimingStats& GetFrameTimingStats() const;
+    void ResetFrameTimingStats();
+
+    // Copies the most recently submitted frame as tightly packed RGBA8 rows, top row first.
+    // Offscreen mode only; waits for that frame to finish on the GPU.
+    bool ReadbackFrame(std::vector<unsigned char>& pixels, uint32_t& width, uint32_t& height);
+    bool IsOffscreen() const { return offscreen; }
+
+    // Threads used by RecordLayers, including the calling thread (0 = one per core)
+    void SetRecordingThreadCount(unsigned int threadCount);
+    // Records layerCount layers in parallel into secondary command buffers and executes them
+    // in layer order. Call between BeginFrame and EndFrame; recordLayer runs on worker threads.
+    void RecordLayers(uint32_t layerCount, const std::function<void(VulkanLayerRecorder& recorder, uint32_t layer)>& recordLayer);
+    const VulkanRecordingStats& GetRecordingStats() const;
+
+    // Device memory usage of buffers created through the sub-allocator
+    VulkanAllocatorStats GetMemoryStats() const;
+
+    // File the pipeline cache is loaded from at Initialize and saved to at Cleanup (call before Initialize)
+    void SetPipelineCachePath(const std::string& path);
+    VulkanPipelineCacheStats GetPipelineCacheStats() const;
+
 private:
+    friend class VulkanLayerRecorder;
+    static constexpr uint32_t kMaxVerticesPerFrame = 65536;
+    static constexpr uint32_t kMaxBindlessTextures = 4096;
+    static constexpr uint32_t kMaxFramesInFlight = 4;
+    static constexpr uint32_t kMaxSpritesPerFrame = 16384;
+
     // Vulkan objects
     VkInstance instance;
     VkPhysicalDevice physicalDevice;
     VkDevice logicalDevice;
     VkQueue graphicsQueue;
     VkQueue presentQueue;
+    VkQueue transferQueue;
+    uint32_t graphicsQueueFamily;
+    uint32_t transferQueueFamily;
     VkSurfaceKHR surface;
     VkSwapchainKHR swapchain;
     std::vector<VkImage> swapchainImages;
@@ -60,25 +313,80 @@ private:
     VkFormat swapchainImageFormat;
     VkExtent2D swapchainExtent;
     VkRenderPass renderPass;
+    VkRenderPass loadRenderPass;    // same attachment, but keeps its contents (after RecordLayers)
     VkPipelineLayout pipelineLayout;
     VkPipeline graphicsPipeline;
+    VkPipeline spritePipeline;      // instanced quads, shares pipelineLayout
+
+    // Bindless textures: one descriptor array indexed by VulkanVertex::textureIndex
+    VkDescriptorSetLayout textureSetLayout;
+    VkDescriptorPool textureDescriptorPool;
+    VkDescriptorSet textureDescriptorSet;
+    VkSampler textureSampler;
+    uint32_t textureCapacity;
+    uint32_t currentTextureIndex;
+    VkPipelineCache pipelineCache;
     std::vector<VkFramebuffer> swapchainFramebuffers;
     VkCommandPool commandPool;
     std::vector<VkCommandBuffer> commandBuffers;
     std::vector<VkSemaphore> imageAvailableSemaphores;
     std::vector<VkSemaphore> renderFinishedSemaphores;
     std::vector<VkFence> inFlightFences;
+    std::vector<VkFence> imagesInFlight;    // fence of the frame last rendering to each swapchain image
+    uint32_t framesInFlight;
+    VulkanPresentMode requestedPresentMode;
+    VulkanFrameTimingStats frameTimingStats;
+    VulkanGpuTimer gpuTimer;
+    VulkanMemoryAllocator memoryAllocator;
+    VulkanStagingRing stagingRing;
     size_t currentFrame;
+    size_t lastSubmittedFrame;      // frame slot of the last EndFrame, SIZE_MAX before the first
+    uint64_t submittedFrames;
+    bool swapchainDirty;            // resized or reported out of date; rebuilt at the next BeginFrame
+    std::vector<RetiredSwapchain> retiredSwapchains;
+    uint32_t currentImageIndex;
+    bool frameInProgress;
+
+    // Per-frame geometry and draw batching
+    std::vector<FrameVertexRing> vertexRings;
+    std::vector<FrameSpriteRing> spriteRings;
+    uint32_t spriteBatchFirst;     // sprites waiting for one instanced draw
+    uint32_t spriteBatchCount;
+    bool spriteRingOverflowed;
+    float viewMatrix[16];
+    VulkanViewPushConstants spriteView;   // view pushed with sprite draws, built when the frame starts
+    VkPipeline activePipeline;     // pipeline selected by UseShader
+    VkPipeline boundPipeline;      // pipeline last bound in the current command buffer
+    VkPipeline batchPipeline;      // pipeline of the draw being accumulated
+    uint32_t batchFirstVertex;
+    uint32_t batchVertexCount;
+    bool vertexRingOverflowed;
+    std::unordered_map<int, std::vector<float>> unitCircles;
+    std::mutex unitCircleMutex;
+
+    // Parallel layer recording
+    WorkerPool recordingWorkers;
+    std::vector<std::vector<RecordingThreadContext>> recordingContexts; // [frame in flight][thread]
+    std::atomic<uint32_t> layerVertexCount;  // shared vertex ring head while layers record
+    std::atomic<uint32_t> layerSpriteCount;  // shared sprite ring head while layers record
+    std::atomic<bool> layerRingOverflowed;
+    VulkanRecordingStats recordingStats;
 
     // Window handle
     HWND windowHandle;
+    bool offscreen;
+    std::vector<OffscreenTarget> offscreenTargets;
 
     // Rendering state
     float clearColor[4];
-    float transform[4]; // x, y, rotation, scale
+    float transform[4]; // x, y, rotation (degrees), scale
+    float drawColor[4];
+    std::string shaderDirectory;
+    std::string pipelineCachePath;
+    VulkanPipelineCacheStats pipelineCacheStats;
 
-    // Texture management
-    std::unordered_map<unsigned int, VkImage> textures;
+    // Texture management, the texture ID doubles as the descriptor array index
+    std::unordered_map<unsigned int, VulkanTexture> textures;
     unsigned int nextTextureId;
     
     // Shader management
@@ -86,7 +394,19 @@ private:
     std::unordered_map<unsigned int, VkShaderModule> fragmentShaders;
     std::unordered_map<unsigned int, VkPipeline> shaderPipelines;
     std::unordered_map<unsigned int, VkPipelineLayout> shaderPipelineLayouts;
+    std::unordered_map<unsigned int, VulkanShaderStatus> shaderStatus;
     unsigned int nextShaderId;
+    unsigned int activeShaderId;   // 0 = built-in pipeline
+
+    // Background pipeline compiles; the pipeline cache is shared (it synchronizes internally)
+    std::vector<std::thread> pipelineCompileThreads;
+    mutable std::mutex pipelineCompileMutex;   // also guards pipelineCacheStats
+    std::condition_variable pipelineCompileAvailable;
+    std::condition_variable pipelineCompileFinished;
+    std::deque<PipelineCompileJob> queuedPipelineCompiles;
+    std::vector<PipelineCompileJob> finishedPipelineCompiles;
+    unsigned int pipelineCompilesInProgress;   // queued or running
+    bool stoppingPipelineCompiles;
     
     // Surface management
     unsigned int surfaceWidth;
@@ -98,18 +418,62 @@ private:
     bool PickPhysicalDevice();
     bool CreateLogicalDevice();
     bool CreateSwapchain();
+    bool RecreateSwapchain();
+    void ReleaseRetiredSwapchains(bool waitIdle);
+    bool CreateOffscreenTargets();
+    void DestroyOffscreenTargets();
     bool CreateImageViews();
     bool CreateRenderPass();
+    bool RecreateRenderPassAndPipelines();
+    bool CreateTextureDescriptors();
+    void DestroyTextureDescriptors();
+    bool CreateTexture(const unsigned char* pixels, uint32_t width, uint32_t height, unsigned int textureId);
+    uint32_t GetTextureIndex(unsigned int textureId) const;
+    void BindTextureDescriptors(VkCommandBuffer commandBuffer);
+    bool CreatePipelineCache();
+    void SavePipelineCache();
     bool CreateGraphicsPipeline();
     bool CreateFramebuffers();
     bool CreateCommandPool();
     bool CreateCommandBuffers();
     bool CreateSyncObjects();
+    bool CreateVertexRings();
+    bool CreateRecordingContexts();
+    void DestroyRecordingContexts();
+    VkCommandBuffer AcquireSecondaryCommandBuffer(uint32_t threadIndex);
+    void BeginRenderPassInstance(VkRenderPass pass, VkSubpassContents contents);
+    void SetViewportAndScissor(VkCommandBuffer commandBuffer);
+    void DestroyVertexRings();
+    bool CreatePipelineLayout(VkPipelineLayout& layout);
+    bool CreatePipeline(VkShaderModule vertShaderModule, VkShaderModule fragShaderModule,
+                        VkPipelineLayout layout, VkPipeline& pipeline,
+                        const VkPipelineVertexInputStateCreateInfo* vertexInput = nullptr);
+    bool CreateSpritePipeline();
+    VulkanSprite* AllocateSprites(uint32_t count);
+    void FlushSpriteBatch();
+    void UpdateSpriteView();
+    void BindFrameBuffers(VkCommandBuffer commandBuffer);
+    void StartPipelineCompileThreads();
+    void StopPipelineCompileThreads();
+    void PipelineCompileLoop();
+    bool CompileShaderPipeline(PipelineCompileJob& job);
+    void InstallCompiledPipelines();
+    VulkanVertex* AllocateVertices(uint32_t count);
+    void FlushDrawBatch();
+    void WriteVertex(VulkanVertex& vertex, float x, float y, float u, float v);
+    const std::vector<float>& GetUnitCircle(int segments);
     VkSurfaceFormatKHR ChooseSwapSurfaceFormat(const std::vector<VkSurfaceFormatKHR>& availableFormats);
     VkPresentModeKHR ChooseSwapPresentMode(const std::vector<VkPresentModeKHR>& availablePresentModes);
     VkExtent2D ChooseSwapExtent(const VkSurfaceCapabilitiesKHR& capabilities);
     uint32_t FindMemoryType(uint32_t typeFilter, VkMemoryPropertyFlags properties);
     void CreateBuffer(VkDeviceSize size, VkBufferUsageFlags usage, VkMemoryPropertyFlags properties, 
-                     VkBuffer& buffer, VkDeviceMemory& bufferMemory);
+                     VkBuffer& buffer, VulkanAllocation& allocation);
+    void DestroyBuffer(VkBuffer& buffer, VulkanAllocation& allocation);
+    VkSharingMode GetResourceSharing(uint32_t* queueFamilies, uint32_t& queueFamilyCount) const;
     void CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    QueueFamilyIndices FindQueueFamilies(VkPhysicalDevice device);
+    SwapChainSupportDetails QuerySwapChainSupport(VkPhysicalDevice device);
+    bool IsDeviceSuitable(VkPhysicalDevice device);
+    std::vector<char> ReadShaderFile(const std::string& filename);
+    VkShaderModule CreateShaderModule(const std::vector<char>& code);
 };
\ No newline at end of file
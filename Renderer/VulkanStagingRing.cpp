@@ -0,0 +1,395 @@
+#include "VulkanStagingRing.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+    // Satisfies the bufferOffset rules of vkCmdCopyBufferToImage for every color format
+    const VkDeviceSize kStagingAlignment = 16;
+}
+
+VulkanStagingRing::VulkanStagingRing()
+    : device(VK_NULL_HANDLE), allocator(nullptr), queue(VK_NULL_HANDLE), commandPool(VK_NULL_HANDLE),
+      timeline(VK_NULL_HANDLE), lastSubmittedValue(0), ringBuffer(VK_NULL_HANDLE), ringMapped(nullptr),
+      capacity(0), head(0), usedBytes(0), batchOpen(false)
+{
+}
+
+VulkanStagingRing::~VulkanStagingRing()
+{
+    Cleanup();
+}
+
+bool VulkanStagingRing::Initialize(VkDevice logicalDevice, VulkanMemoryAllocator* memoryAllocator, VkQueue transferQueue,
+                                   uint32_t queueFamily, VkDeviceSize ringCapacity)
+{
+    device = logicalDevice;
+    allocator = memoryAllocator;
+    queue = transferQueue;
+    capacity = ringCapacity;
+
+    VkCommandPoolCreateInfo poolInfo{};
+    poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+    poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+    poolInfo.queueFamilyIndex = queueFamily;
+    if (vkCreateCommandPool(device, &poolInfo, nullptr, &commandPool) != VK_SUCCESS) {
+        std::cerr << "VulkanStagingRing: failed to create command pool" << std::endl;
+        return false;
+    }
+
+    VkSemaphoreTypeCreateInfo typeInfo{};
+    typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+    typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+    typeInfo.initialValue = 0;
+
+    VkSemaphoreCreateInfo semaphoreInfo{};
+    semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+    semaphoreInfo.pNext = &typeInfo;
+    if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &timeline) != VK_SUCCESS) {
+        std::cerr << "VulkanStagingRing: failed to create timeline semaphore" << std::endl;
+        return false;
+    }
+
+    if (!CreateStagingBuffer(capacity, ringBuffer, ringAllocation)) {
+        return false;
+    }
+    ringMapped = static_cast<char*>(ringAllocation.mapped);
+    return true;
+}
+
+void VulkanStagingRing::Cleanup()
+{
+    if (device == VK_NULL_HANDLE) {
+        return;
+    }
+
+    // An open batch was never submitted; just drop its commands
+    if (batchOpen) {
+        batchOpen = false;
+        ReleaseBatch(batches.back());
+        batches.pop_back();
+    }
+    Wait(lastSubmittedValue);
+    RetireCompletedBatches();
+
+    if (ringBuffer != VK_NULL_HANDLE) {
+        vkDestroyBuffer(device, ringBuffer, nullptr);
+        ringBuffer = VK_NULL_HANDLE;
+    }
+    allocator->Free(ringAllocation);
+    ringMapped = nullptr;
+
+    if (timeline != VK_NULL_HANDLE) {
+        vkDestroySemaphore(device, timeline, nullptr);
+        timeline = VK_NULL_HANDLE;
+    }
+    if (commandPool != VK_NULL_HANDLE) {
+        vkDestroyCommandPool(device, commandPool, nullptr);
+        commandPool = VK_NULL_HANDLE;
+    }
+    freeCommandBuffers.clear();
+
+    head = usedBytes = 0;
+    lastSubmittedValue = 0;
+    device = VK_NULL_HANDLE;
+}
+
+bool VulkanStagingRing::UploadBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset)
+{
+    VkBuffer srcBuffer;
+    VkDeviceSize srcOffset;
+    void* staging = AllocateStaging(size, srcBuffer, srcOffset);
+    if (!staging) {
+        return false;
+    }
+    memcpy(staging, data, (size_t)size);
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = srcOffset;
+    copyRegion.dstOffset = dstOffset;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(batches.back().commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    return true;
+}
+
+bool VulkanStagingRing::CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size)
+{
+    if (!batchOpen && !BeginBatch()) {
+        return false;
+    }
+
+    VkBufferCopy copyRegion{};
+    copyRegion.srcOffset = 0;
+    copyRegion.dstOffset = 0;
+    copyRegion.size = size;
+    vkCmdCopyBuffer(batches.back().commandBuffer, srcBuffer, dstBuffer, 1, &copyRegion);
+    return true;
+}
+
+bool VulkanStagingRing::UploadImage(const void* pixels, VkDeviceSize size, VkImage image, uint32_t width, uint32_t height)
+{
+    VkBuffer srcBuffer;
+    VkDeviceSize srcOffset;
+    void* staging = AllocateStaging(size, srcBuffer, srcOffset);
+    if (!staging) {
+        return false;
+    }
+    memcpy(staging, pixels, (size_t)size);
+
+    VkCommandBuffer commandBuffer = batches.back().commandBuffer;
+
+    VkImageMemoryBarrier barrier{};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+    barrier.image = image;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.srcAccessMask = 0;
+    barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+
+    VkBufferImageCopy region{};
+    region.bufferOffset = srcOffset;
+    region.bufferRowLength = 0;
+    region.bufferImageHeight = 0;
+    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    region.imageSubresource.mipLevel = 0;
+    region.imageSubresource.baseArrayLayer = 0;
+    region.imageSubresource.layerCount = 1;
+    region.imageOffset = {0, 0, 0};
+    region.imageExtent = {width, height, 1};
+    vkCmdCopyBufferToImage(commandBuffer, srcBuffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+
+    // A transfer-only queue cannot name shader stages; the timeline semaphore wait on the
+    // graphics queue makes the write visible to the sampling stages
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = 0;
+    vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                         0, 0, nullptr, 0, nullptr, 1, &barrier);
+    return true;
+}
+
+uint64_t VulkanStagingRing::Submit()
+{
+    if (!batchOpen) {
+        return lastSubmittedValue;
+    }
+
+    Batch& batch = batches.back();
+    batchOpen = false;
+    if (vkEndCommandBuffer(batch.commandBuffer) != VK_SUCCESS) {
+        std::cerr << "VulkanStagingRing: failed to record upload batch" << std::endl;
+        ReleaseBatch(batch);
+        batches.pop_back();
+        return lastSubmittedValue;
+    }
+
+    uint64_t signalValue = lastSubmittedValue + 1;
+
+    VkTimelineSemaphoreSubmitInfo timelineInfo{};
+    timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+    timelineInfo.signalSemaphoreValueCount = 1;
+    timelineInfo.pSignalSemaphoreValues = &signalValue;
+
+    VkSubmitInfo submitInfo{};
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.pNext = &timelineInfo;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &batch.commandBuffer;
+    submitInfo.signalSemaphoreCount = 1;
+    submitInfo.pSignalSemaphores = &timeline;
+
+    if (vkQueueSubmit(queue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+        std::cerr << "VulkanStagingRing: failed to submit upload batch" << std::endl;
+        ReleaseBatch(batch);
+        batches.pop_back();
+        return lastSubmittedValue;
+    }
+
+    batch.timelineValue = signalValue;
+    lastSubmittedValue = signalValue;
+    return signalValue;
+}
+
+uint64_t VulkanStagingRing::GetCompletedValue() const
+{
+    uint64_t value = 0;
+    if (timeline != VK_NULL_HANDLE) {
+        vkGetSemaphoreCounterValue(device, timeline, &value);
+    }
+    return value;
+}
+
+void VulkanStagingRing::Wait(uint64_t value) const
+{
+    if (timeline == VK_NULL_HANDLE || value == 0) {
+        return;
+    }
+
+    VkSemaphoreWaitInfo waitInfo{};
+    waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+    waitInfo.semaphoreCount = 1;
+    waitInfo.pSemaphores = &timeline;
+    waitInfo.pValues = &value;
+    vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+}
+
+bool VulkanStagingRing::BeginBatch()
+{
+    RetireCompletedBatches();
+
+    // Bound the number of submissions in flight, oldest first
+    while (batches.size() >= kMaxBatchesInFlight) {
+        Wait(batches.front().timelineValue);
+        RetireCompletedBatches();
+    }
+
+    VkCommandBuffer commandBuffer;
+    if (!freeCommandBuffers.empty()) {
+        commandBuffer = freeCommandBuffers.back();
+        freeCommandBuffers.pop_back();
+        vkResetCommandBuffer(commandBuffer, 0);
+    } else {
+        VkCommandBufferAllocateInfo allocInfo{};
+        allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        allocInfo.commandPool = commandPool;
+        allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        allocInfo.commandBufferCount = 1;
+        if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+            return false;
+        }
+    }
+
+    VkCommandBufferBeginInfo beginInfo{};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    if (vkBeginCommandBuffer(commandBuffer, &beginInfo) != VK_SUCCESS) {
+        freeCommandBuffers.push_back(commandBuffer);
+        return false;
+    }
+
+    Batch batch;
+    batch.commandBuffer = commandBuffer;
+    batch.timelineValue = 0;
+    batch.ringBytes = 0;
+    batches.push_back(batch);
+    batchOpen = true;
+    return true;
+}
+
+void VulkanStagingRing::RetireCompletedBatches()
+{
+    uint64_t completed = GetCompletedValue();
+    while (!batches.empty() && batches.front().timelineValue != 0 && batches.front().timelineValue <= completed) {
+        // The batch's staging bytes, padding included, are no longer read by the GPU
+        Batch& batch = batches.front();
+        usedBytes -= batch.ringBytes;
+
+        ReleaseBatch(batch);
+        batches.pop_front();
+    }
+
+    if (batches.empty()) {
+        head = 0;
+    }
+}
+
+void VulkanStagingRing::ReleaseBatch(Batch& batch)
+{
+    freeCommandBuffers.push_back(batch.commandBuffer);
+    for (size_t i = 0; i < batch.oversizedBuffers.size(); i++) {
+        vkDestroyBuffer(device, batch.oversizedBuffers[i], nullptr);
+        allocator->Free(batch.oversizedAllocations[i]);
+    }
+    batch.oversizedBuffers.clear();
+    batch.oversizedAllocations.clear();
+}
+
+void* VulkanStagingRing::AllocateStaging(VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset)
+{
+    if (!batchOpen && !BeginBatch()) {
+        return nullptr;
+    }
+
+    // Uploads that do not fit the ring get a staging buffer of their own, freed with the batch
+    if (size > capacity / 2) {
+        VulkanAllocation allocation;
+        if (!CreateStagingBuffer(size, buffer, allocation)) {
+            return nullptr;
+        }
+        batches.back().oversizedBuffers.push_back(buffer);
+        batches.back().oversizedAllocations.push_back(allocation);
+        offset = 0;
+        return allocation.mapped;
+    }
+
+    for (;;) {
+        VkDeviceSize start = (head + kStagingAlignment - 1) & ~(kStagingAlignment - 1);
+        VkDeviceSize padding = start - head;
+        if (start + size > capacity) {
+            // Skip the unusable end of the ring and wrap to the start
+            padding = capacity - head;
+            start = 0;
+        }
+
+        if (usedBytes + padding + size <= capacity) {
+            head = start + size;
+            usedBytes += padding + size;
+            batches.back().ringBytes += padding + size;
+            offset = start;
+            buffer = ringBuffer;
+            return ringMapped + start;
+        }
+
+        // Ring is full. Wait for the oldest submitted batch, or submit the open one
+        // when it is the only batch left holding ring space.
+        if (batches.size() == 1) {
+            Submit();
+            Wait(lastSubmittedValue);
+            RetireCompletedBatches();
+            if (!BeginBatch()) {
+                return nullptr;
+            }
+        } else {
+            Wait(batches.front().timelineValue);
+            RetireCompletedBatches();
+        }
+    }
+}
+
+bool VulkanStagingRing::CreateStagingBuffer(VkDeviceSize size, VkBuffer& buffer, VulkanAllocation& allocation)
+{
+    VkBufferCreateInfo bufferInfo{};
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    if (vkCreateBuffer(device, &bufferInfo, nullptr, &buffer) != VK_SUCCESS) {
+        std::cerr << "VulkanStagingRing: failed to create staging buffer" << std::endl;
+        return false;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(device, buffer, &requirements);
+    if (!allocator->Allocate(requirements, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+                             VulkanResourceKind::Linear, allocation) || !allocation.mapped) {
+        std::cerr << "VulkanStagingRing: failed to allocate staging memory" << std::endl;
+        vkDestroyBuffer(device, buffer, nullptr);
+        buffer = VK_NULL_HANDLE;
+        allocator->Free(allocation);
+        return false;
+    }
+
+    vkBindBufferMemory(device, buffer, allocation.memory, allocation.offset);
+    return true;
+}
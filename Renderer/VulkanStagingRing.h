@@ -0,0 +1,76 @@
+#pragma once
+#include "VulkanMemoryAllocator.h"
+#include <vulkan/vulkan.h>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+// Collects buffer and image uploads into one command buffer per submission instead of
+// one submit + vkQueueWaitIdle per copy. Staging data lives in a persistently mapped
+// ring buffer; every submission signals the next value of a timeline semaphore, and
+// ring space is reclaimed once the semaphore has passed that value.
+class VulkanStagingRing {
+public:
+    static const VkDeviceSize kDefaultCapacity = 32ull * 1024 * 1024;
+    static const uint32_t kMaxBatchesInFlight = 8;
+
+    VulkanStagingRing();
+    ~VulkanStagingRing();
+
+    // queueFamily is the family of queue (a dedicated transfer family when the device has one)
+    bool Initialize(VkDevice device, VulkanMemoryAllocator* allocator, VkQueue queue, uint32_t queueFamily,
+                    VkDeviceSize capacity = kDefaultCapacity);
+    void Cleanup();
+
+    // Record uploads into the open batch. They execute at the next Submit.
+    bool UploadBuffer(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset = 0);
+    bool CopyBuffer(VkBuffer srcBuffer, VkBuffer dstBuffer, VkDeviceSize size);
+    // Uploads tightly packed pixels to mip 0 and leaves the image in SHADER_READ_ONLY_OPTIMAL
+    bool UploadImage(const void* pixels, VkDeviceSize size, VkImage image, uint32_t width, uint32_t height);
+
+    // Submits the open batch and returns the timeline value it signals,
+    // or the last submitted value when nothing was recorded
+    uint64_t Submit();
+
+    bool HasPendingWork() const { return batchOpen; }
+    VkSemaphore GetTimelineSemaphore() const { return timeline; }
+    uint64_t GetLastSubmittedValue() const { return lastSubmittedValue; }
+    uint64_t GetCompletedValue() const;
+    // Blocks on the host until value has completed; only needed at shutdown or when the ring is full
+    void Wait(uint64_t value) const;
+
+private:
+    struct Batch {
+        VkCommandBuffer commandBuffer;
+        uint64_t timelineValue;   // 0 while the batch is still being recorded
+        VkDeviceSize ringBytes;   // ring bytes (including alignment padding) the batch holds
+        std::vector<VkBuffer> oversizedBuffers;  // uploads too large for the ring
+        std::vector<VulkanAllocation> oversizedAllocations;
+    };
+
+    bool BeginBatch();
+    void RetireCompletedBatches();
+    void ReleaseBatch(Batch& batch);
+    void* AllocateStaging(VkDeviceSize size, VkBuffer& buffer, VkDeviceSize& offset);
+    bool CreateStagingBuffer(VkDeviceSize size, VkBuffer& buffer, VulkanAllocation& allocation);
+
+    VkDevice device;
+    VulkanMemoryAllocator* allocator;
+    VkQueue queue;
+    VkCommandPool commandPool;
+    VkSemaphore timeline;
+    uint64_t lastSubmittedValue;
+
+    VkBuffer ringBuffer;
+    VulkanAllocation ringAllocation;
+    char* ringMapped;
+    VkDeviceSize capacity;
+    VkDeviceSize head;            // next free byte
+    // Bytes held by unretired batches, alignment and wrap padding included. Batches retire in
+    // ring order, so the held bytes are the usedBytes bytes just before head (wrapping)
+    VkDeviceSize usedBytes;
+
+    std::deque<Batch> batches;    // in submission order, the open batch (if any) last
+    std::vector<VkCommandBuffer> freeCommandBuffers;
+    bool batchOpen;
+};
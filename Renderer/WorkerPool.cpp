@@ -0,0 +1,140 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(unsigned int threadCount)
+    : task(nullptr), threadTask(nullptr), taskCount(0), nextIndex(0), generation(0), busyWorkers(0), stopping(false)
+{
+    StartWorkers(threadCount);
+}
+
+WorkerPool::~WorkerPool()
+{
+    StopWorkers();
+}
+
+void WorkerPool::Resize(unsigned int threadCount)
+{
+    StopWorkers();
+    StartWorkers(threadCount);
+}
+
+unsigned int WorkerPool::GetThreadCount() const
+{
+    return static_cast<unsigned int>(workers.size()) + 1;
+}
+
+void WorkerPool::ParallelFor(uint32_t count, const std::function<void(uint32_t index, uint32_t threadIndex)>& work)
+{
+    if (count == 0) {
+        return;
+    }
+
+    // Not worth waking anyone for a single item
+    if (workers.empty() || count == 1) {
+        for (uint32_t i = 0; i < count; i++) {
+            work(i, 0);
+        }
+        return;
+    }
+
+    Dispatch(&work, count, nullptr);
+}
+
+void WorkerPool::RunOnEachThread(const std::function<void(uint32_t threadIndex)>& work)
+{
+    if (workers.empty()) {
+        work(0);
+        return;
+    }
+
+    Dispatch(nullptr, 0, &work);
+}
+
+void WorkerPool::Dispatch(const std::function<void(uint32_t, uint32_t)>* work, uint32_t count,
+                          const std::function<void(uint32_t)>* threadWork)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        task = work;
+        threadTask = threadWork;
+        taskCount = count;
+        nextIndex.store(0);
+        busyWorkers = static_cast<unsigned int>(workers.size());
+        generation++;
+    }
+    workAvailable.notify_all();
+
+    if (threadWork) {
+        (*threadWork)(0);
+    } else {
+        RunTasks(0);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return busyWorkers == 0; });
+    task = nullptr;
+    threadTask = nullptr;
+}
+
+void WorkerPool::StartWorkers(unsigned int threadCount)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    stopping = false;
+    for (unsigned int i = 1; i < threadCount; i++) {
+        workers.emplace_back(&WorkerPool::WorkerLoop, this, i, generation);
+    }
+}
+
+void WorkerPool::StopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    workers.clear();
+}
+
+void WorkerPool::WorkerLoop(uint32_t threadIndex, uint64_t startGeneration)
+{
+    // Taken when the thread was created, so work posted before the thread first runs is not missed
+    uint64_t seenGeneration = startGeneration;
+    for (;;) {
+        const std::function<void(uint32_t)>* threadWork = nullptr;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+            threadWork = threadTask;
+        }
+
+        if (threadWork) {
+            (*threadWork)(threadIndex);
+        } else {
+            RunTasks(threadIndex);
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--busyWorkers == 0) {
+            workDone.notify_one();
+        }
+    }
+}
+
+void WorkerPool::RunTasks(uint32_t threadIndex)
+{
+    // Items are claimed one at a time so uneven items still balance across threads
+    for (uint32_t i = nextIndex.fetch_add(1); i < taskCount; i = nextIndex.fetch_add(1)) {
+        (*task)(i, threadIndex);
+    }
+}
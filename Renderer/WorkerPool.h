@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for fork/join work inside a frame.
+// The calling thread takes part as thread 0, so a pool of N threads starts N - 1 workers.
+class WorkerPool
+{
+public:
+    // threadCount 0 uses one thread per hardware core
+    explicit WorkerPool(unsigned int threadCount = 0);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    // Must not be called while ParallelFor is running
+    void Resize(unsigned int threadCount);
+    unsigned int GetThreadCount() const;
+
+    // Runs task(index, threadIndex) for every index in [0, count) and returns when all are done.
+    // threadIndex is stable per thread and lower than GetThreadCount().
+    void ParallelFor(uint32_t count, const std::function<void(uint32_t index, uint32_t threadIndex)>& task);
+
+    // Runs task(threadIndex) exactly once on every thread of the pool and returns when all are done.
+    // Work bound to a threadIndex always runs on the same OS thread until the next Resize,
+    // which is what thread-affine state such as a GL context needs.
+    void RunOnEachThread(const std::function<void(uint32_t threadIndex)>& task);
+
+private:
+    void StartWorkers(unsigned int threadCount);
+    void StopWorkers();
+    void WorkerLoop(uint32_t threadIndex, uint64_t startGeneration);
+    void Dispatch(const std::function<void(uint32_t, uint32_t)>* work, uint32_t count,
+                  const std::function<void(uint32_t)>* threadWork);
+    void RunTasks(uint32_t threadIndex);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable workDone;
+
+    const std::function<void(uint32_t, uint32_t)>* task;
+    const std::function<void(uint32_t)>* threadTask;   // set instead of task by RunOnEachThread
+    uint32_t taskCount;
+    std::atomic<uint32_t> nextIndex;
+    uint64_t generation;        // bumped for every ParallelFor so workers see new work
+    unsigned int busyWorkers;
+    bool stopping;
+};
@@ -0,0 +1,208 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#ifdef _WIN32
+#include <windows.h>
+#include <mmsystem.h>
+#endif
+
+namespace {
+    double ToMs(FramePacer::Clock::duration duration) {
+        return std::chrono::duration<double, std::milli>(duration).count();
+    }
+
+    // sleep误差估计最多按这么多样本平均，之后按指数衰减，让估计值能跟上系统负载的变化
+    const uint64_t kMaxSleepSamples = 1000;
+}
+
+FramePacer::FramePacer(double target_hz, size_t history_size)
+    : main_(), target_hz_(0.0), started_(false),
+      sleep_mean_ms_(1.0), sleep_variance_(0.0), sleep_samples_(0), sleep_estimate_ms_(1.0),
+      frame_times_ms_(std::max<size_t>(history_size, 1), 0.0), frame_time_next_(0), frames_(0) {
+#ifdef _WIN32
+    // 默认的系统定时器精度约为15.6ms，sleep(1ms)会睡过整个时间片
+    timeBeginPeriod(1);
+#endif
+    SetTargetRate(target_hz);
+}
+
+FramePacer::~FramePacer() {
+#ifdef _WIN32
+    timeEndPeriod(1);
+#endif
+}
+
+void FramePacer::SetTargetRate(double hz) {
+    target_hz_ = hz > 0.0 ? hz : 60.0;
+    // 保留已经排定的截止时间和错过次数，新周期从下一帧开始生效
+    InitTimeline(main_, target_hz_);
+}
+
+void FramePacer::SetRate(uint32_t id, double hz) {
+    if (hz <= 0.0) {
+        RemoveRate(id);
+        return;
+    }
+    if (id >= timelines_.size()) {
+        timelines_.resize(id + 1, Timeline());
+    }
+
+    Timeline& timeline = timelines_[id];
+    if (timeline.hz <= 0.0) {
+        // 新注册的节奏从零计数，并且立即到期
+        timeline = Timeline();
+        timeline.deadline = Clock::now();
+    }
+    InitTimeline(timeline, hz);
+}
+
+void FramePacer::RemoveRate(uint32_t id) {
+    if (id < timelines_.size()) {
+        timelines_[id] = Timeline();
+    }
+}
+
+bool FramePacer::HasRate(uint32_t id) const {
+    return id < timelines_.size() && timelines_[id].hz > 0.0;
+}
+
+uint64_t FramePacer::GetMissedDeadlines(uint32_t id) const {
+    return HasRate(id) ? timelines_[id].missed : 0;
+}
+
+bool FramePacer::IsDue(uint32_t id) const {
+    return HasRate(id) && timelines_[id].due;
+}
+
+void FramePacer::WaitForNextFrame(bool precise) {
+    Clock::time_point now = Clock::now();
+    if (!started_) {
+        started_ = true;
+        last_frame_ = now;
+        main_.deadline = now;
+        for (Timeline& timeline : timelines_) {
+            timeline.deadline = now;
+        }
+    } else {
+        Clock::time_point next = main_.deadline;
+        for (const Timeline& timeline : timelines_) {
+            if (timeline.hz > 0.0) {
+                next = std::min(next, timeline.deadline);
+            }
+        }
+        if (precise) {
+            PreciseSleepUntil(next);
+        } else {
+            std::this_thread::sleep_until(next);
+        }
+        now = Clock::now();
+    }
+
+    Advance(main_, now);
+    for (Timeline& timeline : timelines_) {
+        if (timeline.hz > 0.0) {
+            Advance(timeline, now);
+        }
+    }
+
+    if (main_.due) {
+        if (frames_ > 0) {
+            RecordFrame(ToMs(now - last_frame_));
+        }
+        last_frame_ = now;
+        ++frames_;
+    }
+}
+
+FramePacerStats FramePacer::GetStats() const {
+    FramePacerStats stats = {};
+    stats.frames = frames_;
+    stats.missed_deadlines = main_.missed;
+
+    // 第一帧没有间隔，环形缓冲未写满时只取已写入的部分
+    size_t recorded = static_cast<size_t>(std::min<uint64_t>(frames_ > 0 ? frames_ - 1 : 0, frame_times_ms_.size()));
+    if (recorded == 0) {
+        return stats;
+    }
+
+    std::vector<double> sorted(frame_times_ms_.begin(), frame_times_ms_.begin() + recorded);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double frame_ms : sorted) {
+        total += frame_ms;
+    }
+    auto percentile = [&sorted](double p) {
+        size_t index = static_cast<size_t>(std::ceil(p * sorted.size())) - 1;
+        return sorted[std::min(index, sorted.size() - 1)];
+    };
+
+    stats.average_ms = total / sorted.size();
+    stats.p50_ms = percentile(0.50);
+    stats.p95_ms = percentile(0.95);
+    stats.p99_ms = percentile(0.99);
+    stats.max_ms = sorted.back();
+    return stats;
+}
+
+void FramePacer::ResetStats() {
+    frames_ = 0;
+    frame_time_next_ = 0;
+    main_.missed = 0;
+    for (Timeline& timeline : timelines_) {
+        timeline.missed = 0;
+    }
+}
+
+void FramePacer::InitTimeline(Timeline& timeline, double hz) {
+    timeline.hz = hz;
+    timeline.period = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz));
+}
+
+void FramePacer::Advance(Timeline& timeline, Clock::time_point now) {
+    timeline.due = now >= timeline.deadline;
+    if (!timeline.due) {
+        return;
+    }
+
+    // 截止时间在原来的基础上累加，不随唤醒时刻漂移
+    timeline.deadline += timeline.period;
+    if (now >= timeline.deadline) {
+        // 已经落后至少一个周期：跳过错过的截止时间，相位不变
+        uint64_t behind = static_cast<uint64_t>((now - timeline.deadline) / timeline.period) + 1;
+        timeline.missed += behind;
+        timeline.deadline += timeline.period * static_cast<Clock::rep>(behind);
+    }
+}
+
+void FramePacer::PreciseSleepUntil(Clock::time_point deadline) {
+    // 剩余时间大于sleep误差的估计值时才sleep，每次sleep 1ms并用实际耗时更新估计
+    for (;;) {
+        Clock::time_point start = Clock::now();
+        if (ToMs(deadline - start) <= sleep_estimate_ms_) {
+            break;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        double observed = ToMs(Clock::now() - start);
+
+        if (sleep_samples_ < kMaxSleepSamples) {
+            ++sleep_samples_;
+        }
+        double weight = 1.0 / sleep_samples_;
+        double delta = observed - sleep_mean_ms_;
+        sleep_mean_ms_ += weight * delta;
+        sleep_variance_ = (1.0 - weight) * (sleep_variance_ + weight * delta * delta);
+        sleep_estimate_ms_ = sleep_mean_ms_ + std::sqrt(sleep_variance_);
+    }
+
+    // 最后一段自旋，让出时间片以免独占核心
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+}
+
+void FramePacer::RecordFrame(double frame_ms) {
+    frame_times_ms_[frame_time_next_] = frame_ms;
+    frame_time_next_ = (frame_time_next_ + 1) % frame_times_ms_.size();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+// 帧时间统计（主节奏最近一段时间内相邻两帧的间隔）
+struct FramePacerStats {
+    uint64_t frames;             // 主节奏的总帧数
+    uint64_t missed_deadlines;   // 因为上一帧耗时过长而错过、被跳过的截止时间数
+    double average_ms;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+// 主循环的帧节奏控制。
+// 截止时间按单调时钟的绝对时刻计算，每帧在上一个截止时间上加一个周期，而不是从当前时间重新起算，
+// 所以sleep的误差不会积累成漂移；落后超过一个周期时跳过错过的截止时间并记入missed_deadlines，保持原来的相位。
+// 等待时先以1ms为单位sleep，剩余时间小于sleep误差的估计值后再让出CPU自旋到截止时间，
+// 只有最后一小段时间占用CPU。
+// 除了主节奏，还可以用id（如窗口槽位）注册额外的节奏，WaitForNextFrame等到所有节奏中最早的截止时间。
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FramePacer(double target_hz = 60.0, size_t history_size = 1024);
+    ~FramePacer();
+
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // 主节奏的目标帧率
+    void SetTargetRate(double hz);
+    double GetTargetRate() const { return target_hz_; }
+
+    // 额外节奏，hz <= 0时等同于RemoveRate
+    void SetRate(uint32_t id, double hz);
+    void RemoveRate(uint32_t id);
+    bool HasRate(uint32_t id) const;
+    uint64_t GetMissedDeadlines(uint32_t id) const;
+
+    // 等到下一个截止时间，然后更新各节奏本帧是否到期。第一次调用立即返回，所有节奏都到期。
+    // precise为false时直接sleep到截止时间、不自旋，用于本帧没有东西要画的空闲帧
+    void WaitForNextFrame(bool precise = true);
+    bool IsStarted() const { return started_; }
+    // 本帧主节奏是否到期
+    bool IsFrameDue() const { return main_.due; }
+    // 本帧额外节奏id是否到期，没有注册的id返回false
+    bool IsDue(uint32_t id) const;
+
+    FramePacerStats GetStats() const;
+    void ResetStats();
+
+private:
+    struct Timeline {
+        double hz;                   // 0表示未注册
+        Clock::duration period;
+        Clock::time_point deadline;
+        uint64_t missed;
+        bool due;
+    };
+
+    // 只设置频率和周期，截止时间和错过次数保持不变（计数由ResetStats清零）
+    static void InitTimeline(Timeline& timeline, double hz);
+    // now已到截止时间时标记到期并推进到下一个未来的截止时间
+    static void Advance(Timeline& timeline, Clock::time_point now);
+    void PreciseSleepUntil(Clock::time_point deadline);
+    void RecordFrame(double frame_ms);
+
+    Timeline main_;
+    std::vector<Timeline> timelines_;   // 按id下标存放
+    double target_hz_;
+    bool started_;
+    Clock::time_point last_frame_;
+
+    // sleep误差的在线估计（均值和方差），用于决定何时改为自旋
+    double sleep_mean_ms_;
+    double sleep_variance_;
+    uint64_t sleep_samples_;
+    double sleep_estimate_ms_;
+
+    // 最近history_size帧的帧时间环形缓冲
+    std::vector<double> frame_times_ms_;
+    size_t frame_time_next_;
+    uint64_t frames_;
+};
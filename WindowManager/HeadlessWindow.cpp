@@ -0,0 +1,201 @@
+#include "HeadlessWindow.h"
+#include <algorithm>
+
+HeadlessWindow::HeadlessWindow()
+    : x_(0), y_(0), width_(0), height_(0), visible_(false), valid_(false), rendering_(false),
+      rendered_(false), listener_(nullptr), processed_events_(0), present_count_(0) {
+}
+
+HeadlessWindow::~HeadlessWindow() {
+    if (valid_) {
+        Destroy();
+    }
+}
+
+bool HeadlessWindow::Create(const std::string& title, int x, int y, int width, int height) {
+    if (valid_) {
+        return false; // 窗口已存在
+    }
+
+    title_ = title;
+    x_ = x;
+    y_ = y;
+    valid_ = true;
+    SetSize(width, height);
+    return true;
+}
+
+void HeadlessWindow::Destroy() {
+    if (valid_) {
+        valid_ = false;
+        visible_ = false;
+        pixels_.clear();
+        pixels_.shrink_to_fit();
+        WindowEvent discarded;
+        while (pending_events_.Pop(discarded)) {
+        }
+    }
+}
+
+void HeadlessWindow::Show() {
+    if (valid_) {
+        visible_ = true;
+    }
+}
+
+void HeadlessWindow::Hide() {
+    if (valid_) {
+        visible_ = false;
+    }
+}
+
+void HeadlessWindow::Update() {
+    // 只处理调用时已在队列中的事件，事件处理中再入队的留到下一次Update
+    size_t count = pending_events_.GetSize();
+    WindowEvent event;
+    for (size_t i = 0; i < count && valid_ && pending_events_.Pop(event); ++i) {
+        ApplyEvent(event);
+        processed_events_++;
+    }
+}
+
+bool HeadlessWindow::IsVisible() const {
+    return visible_;
+}
+
+bool HeadlessWindow::IsValid() const {
+    return valid_;
+}
+
+void HeadlessWindow::SetTitle(const std::string& title) {
+    title_ = title;
+}
+
+std::string HeadlessWindow::GetTitle() const {
+    return title_;
+}
+
+void HeadlessWindow::SetPosition(int x, int y) {
+    if (valid_) {
+        x_ = x;
+        y_ = y;
+        NotifyGeometryChanged();
+    }
+}
+
+void HeadlessWindow::GetPosition(int& x, int& y) const {
+    if (valid_) {
+        x = x_;
+        y = y_;
+    }
+}
+
+void HeadlessWindow::SetSize(int width, int height) {
+    if (valid_) {
+        width_ = std::max(width, 0);
+        height_ = std::max(height, 0);
+        pixels_.assign(static_cast<size_t>(width_) * height_, 0);
+        NotifyGeometryChanged();
+    }
+}
+
+void HeadlessWindow::GetSize(int& width, int& height) const {
+    if (valid_) {
+        width = width_;
+        height = height_;
+    }
+}
+
+int HeadlessWindow::GetX() const {
+    return x_;
+}
+
+int HeadlessWindow::GetY() const {
+    return y_;
+}
+
+int HeadlessWindow::GetWidth() const {
+    return width_;
+}
+
+int HeadlessWindow::GetHeight() const {
+    return height_;
+}
+
+void HeadlessWindow::SetEventListener(IWindowEventListener* listener) {
+    listener_ = listener;
+}
+
+void* HeadlessWindow::GetNativeHandle() {
+    return nullptr;
+}
+
+void HeadlessWindow::BeginRender() {
+    rendering_ = valid_;
+}
+
+void HeadlessWindow::EndRender() {
+    if (rendering_) {
+        rendering_ = false;
+        rendered_ = true;
+    }
+}
+
+void HeadlessWindow::Present() {
+    if (rendered_) {
+        rendered_ = false;
+        present_count_++;
+    }
+}
+
+bool HeadlessWindow::PushEvent(const WindowEvent& event) {
+    if (!valid_) {
+        return false;
+    }
+    WindowEvent stamped = event;
+    if (stamped.timestamp_ns == 0) {
+        stamped.timestamp_ns = GetWindowEventTimestamp();
+    }
+    return pending_events_.Push(stamped);
+}
+
+void HeadlessWindow::Clear(uint32_t color) {
+    std::fill(pixels_.begin(), pixels_.end(), color);
+}
+
+void HeadlessWindow::ApplyEvent(const WindowEvent& event) {
+    switch (event.type) {
+        case WindowEventType::Move:
+            SetPosition(event.x, event.y);
+            break;
+        case WindowEventType::Resize:
+            SetSize(event.width, event.height);
+            break;
+        case WindowEventType::Show:
+            Show();
+            break;
+        case WindowEventType::Hide:
+            Hide();
+            break;
+        case WindowEventType::Close:
+            Destroy();
+            break;
+        case WindowEventType::Activate:
+            if (listener_) {
+                listener_->OnWindowActivated(this);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (listener_) {
+        listener_->OnWindowEvent(this, event);
+    }
+}
+
+void HeadlessWindow::NotifyGeometryChanged() {
+    if (listener_) {
+        listener_->OnWindowGeometryChanged(this, x_, y_, width_, height_);
+    }
+}
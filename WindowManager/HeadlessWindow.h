@@ -0,0 +1,73 @@
+#pragma once
+#include "IWindow.h"
+#include "WindowEventQueue.h"
+#include <cstdint>
+#include <vector>
+
+// 无窗口系统的虚拟窗口：几何、可见性和像素表面都保存在内存中，
+// 事件由PushEvent合成，在Update中依次应用并转发给监听者。用于在Linux构建机上运行和压测WindowManager。
+class HeadlessWindow : public IWindow {
+public:
+    HeadlessWindow();
+    virtual ~HeadlessWindow();
+
+    // IWindow接口实现
+    bool Create(const std::string& title, int x, int y, int width, int height) override;
+    void Destroy() override;
+    void Show() override;
+    void Hide() override;
+    void Update() override;
+
+    bool IsVisible() const override;
+    bool IsValid() const override;
+
+    void SetTitle(const std::string& title) override;
+    std::string GetTitle() const override;
+    void SetPosition(int x, int y) override;
+    void GetPosition(int& x, int& y) const override;
+    void SetSize(int width, int height) override;
+    void GetSize(int& width, int& height) const override;
+    int GetX() const override;
+    int GetY() const override;
+    int GetWidth() const override;
+    int GetHeight() const override;
+
+    void SetEventListener(IWindowEventListener* listener) override;
+
+    // 没有原生句柄，返回nullptr（Vulkan渲染器在nullptr下进入离屏模式）
+    void* GetNativeHandle() override;
+    void BeginRender() override;
+    void EndRender() override;
+    void Present() override;
+
+    // 合成事件源：事件先入队，下一次Update时应用。相当于操作系统的输入队列，
+    // 可以在一个单独的输入线程上调用（单生产者），队列满时返回false
+    bool PushEvent(const WindowEvent& event);
+    size_t GetPendingEventCount() const { return pending_events_.GetSize(); }
+    uint64_t GetProcessedEventCount() const { return processed_events_; }
+
+    // 像素表面（RGBA8，每像素一个uint32_t，行宽等于窗口宽度），大小随SetSize变化
+    uint32_t* GetPixels() { return pixels_.data(); }
+    const uint32_t* GetPixels() const { return pixels_.data(); }
+    void Clear(uint32_t color);
+
+    // 渲染完成后Present被调用的次数，相当于呈现的帧数
+    uint64_t GetPresentCount() const { return present_count_; }
+
+private:
+    void ApplyEvent(const WindowEvent& event);
+    void NotifyGeometryChanged();
+
+    std::string title_;
+    int x_, y_;
+    int width_, height_;
+    bool visible_;
+    bool valid_;
+    bool rendering_;
+    bool rendered_;     // EndRender之后、Present之前
+    IWindowEventListener* listener_;
+    std::vector<uint32_t> pixels_;
+    WindowEventQueue pending_events_;
+    uint64_t processed_events_;
+    uint64_t present_count_;
+};
@@ -1,6 +1,24 @@
 #pragma once
+#include "WindowEvent.h"
 #include <string>
 
+class IWindow;
+
+// 窗口事件监听接口
+class IWindowEventListener {
+public:
+    virtual ~IWindowEventListener() = default;
+
+    // 窗口位置或大小改变后调用（移动/缩放事件或SetPosition/SetSize），参数为新的几何信息
+    virtual void OnWindowGeometryChanged(IWindow* /*window*/, int /*x*/, int /*y*/, int /*width*/, int /*height*/) {}
+
+    // 窗口被激活（用户点击、切换到该窗口）时调用
+    virtual void OnWindowActivated(IWindow* /*window*/) {}
+
+    // 窗口和输入事件归一化后在消息泵线程上调用，监听者应尽快返回（如只是入队）
+    virtual void OnWindowEvent(IWindow* /*window*/, const WindowEvent& /*event*/) {}
+};
+
 // 窗口接口定义
 class IWindow {
 public:
@@ -29,8 +47,13 @@ public:
     virtual int GetWidth() const = 0;
     virtual int GetHeight() const = 0;
 
+    // 设置事件监听者（nullptr取消），窗口不拥有监听者
+    virtual void SetEventListener(IWindowEventListener* listener) = 0;
+
     // 渲染相关
     virtual void* GetNativeHandle() = 0;  // 获取原生窗口句柄
     virtual void BeginRender() = 0;
     virtual void EndRender() = 0;
+    // 呈现已渲染好的画面；WindowManager在所有窗口渲染完成后按堆叠顺序调用
+    virtual void Present() = 0;
 };
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+#include <algorithm>
+
+// 表示矩形区域的结构体
+struct Rect {
+    int x, y, width, height;
+    
+    Rect(int x = 0, int y = 0, int width = 0, int height = 0) 
+        : x(x), y(y), width(width), height(height) {}
+    
+    // 检查两个矩形是否相交
+    bool Intersects(const Rect& other) const {
+        return x < other.x + other.width &&
+               x + width > other.x &&
+               y < other.y + other.height &&
+               y + height > other.y;
+    }
+    
+    // 计算两个矩形的交集
+    Rect GetIntersection(const Rect& other) const {
+        int left = std::max(x, other.x);
+        int top = std::max(y, other.y);
+        int right = std::min(x + width, other.x + other.width);
+        int bottom = std::min(y + height, other.y + other.height);
+        
+        if (left < right && top < bottom) {
+            return Rect(left, top, right - left, bottom - top);
+        }
+        return Rect(0, 0, 0, 0); // 无交集
+    }
+};
@@ -0,0 +1,279 @@
+#include "Region.h"
+
+Region::Region() : bounds_(0, 0, 0, 0) {
+}
+
+Region::Region(const Rect& rect) : bounds_(0, 0, 0, 0) {
+    if (rect.width > 0 && rect.height > 0) {
+        rects_.push_back(rect);
+        bounds_ = rect;
+    }
+}
+
+Region Region::FromRects(const std::vector<Rect>& rects) {
+    std::vector<Region> regions;
+    regions.reserve(rects.size());
+    for (const Rect& rect : rects) {
+        if (rect.width > 0 && rect.height > 0) {
+            regions.emplace_back(rect);
+        }
+    }
+    if (regions.empty()) {
+        return Region();
+    }
+
+    // 两两合并，每一层的总代价与区域大小成正比，共log n层
+    while (regions.size() > 1) {
+        size_t merged = 0;
+        for (size_t i = 0; i < regions.size(); i += 2) {
+            if (i + 1 < regions.size()) {
+                regions[merged++] = regions[i].Union(regions[i + 1]);
+            } else {
+                regions[merged++] = std::move(regions[i]);
+            }
+        }
+        regions.resize(merged);
+    }
+    return std::move(regions[0]);
+}
+
+void Region::Clear() {
+    rects_.clear();
+    bounds_ = Rect(0, 0, 0, 0);
+}
+
+int64_t Region::GetArea() const {
+    int64_t area = 0;
+    for (const Rect& rect : rects_) {
+        area += static_cast<int64_t>(rect.width) * rect.height;
+    }
+    return area;
+}
+
+bool Region::Contains(int x, int y) const {
+    for (const Rect& rect : rects_) {
+        if (rect.y > y) {
+            break;
+        }
+        if (y < rect.y + rect.height && x >= rect.x && x < rect.x + rect.width) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Region::Intersects(const Rect& rect) const {
+    if (rect.width <= 0 || rect.height <= 0 || rects_.empty() || !bounds_.Intersects(rect)) {
+        return false;
+    }
+    for (const Rect& own : rects_) {
+        if (own.y >= rect.y + rect.height) {
+            break;
+        }
+        if (own.Intersects(rect)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Region::operator==(const Region& other) const {
+    if (rects_.size() != other.rects_.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < rects_.size(); ++i) {
+        const Rect& a = rects_[i];
+        const Rect& b = other.rects_[i];
+        if (a.x != b.x || a.y != b.y || a.width != b.width || a.height != b.height) {
+            return false;
+        }
+    }
+    return true;
+}
+
+Region Region::Union(const Region& other) const {
+    return Combine(*this, other, Operation::Union);
+}
+
+Region Region::Intersect(const Region& other) const {
+    return Combine(*this, other, Operation::Intersect);
+}
+
+Region Region::Subtract(const Region& other) const {
+    return Combine(*this, other, Operation::Subtract);
+}
+
+void Region::Translate(int dx, int dy) {
+    for (Rect& rect : rects_) {
+        rect.x += dx;
+        rect.y += dy;
+    }
+    bounds_.x += dx;
+    bounds_.y += dy;
+}
+
+Region Region::Combine(const Region& a, const Region& b, Operation operation) {
+    // 一方为空或边界不相交时结果可以直接得出
+    bool disjoint = a.IsEmpty() || b.IsEmpty() || !a.bounds_.Intersects(b.bounds_);
+    if (disjoint) {
+        switch (operation) {
+            case Operation::Intersect:
+                return Region();
+            case Operation::Subtract:
+                return a;
+            case Operation::Union:
+                if (a.IsEmpty()) return b;
+                if (b.IsEmpty()) return a;
+                break;
+        }
+    }
+
+    // 两个区域所有带的上下边把平面切成若干水平条，每条内两边的区间列表都不变
+    std::vector<int> edges;
+    edges.reserve((a.rects_.size() + b.rects_.size()) * 2);
+    for (const Rect& rect : a.rects_) {
+        edges.push_back(rect.y);
+        edges.push_back(rect.y + rect.height);
+    }
+    for (const Rect& rect : b.rects_) {
+        edges.push_back(rect.y);
+        edges.push_back(rect.y + rect.height);
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    Region result;
+    result.rects_.reserve(a.rects_.size() + b.rects_.size());
+    size_t a_index = 0;
+    size_t b_index = 0;
+    size_t last_band_start = static_cast<size_t>(-1);
+    std::vector<Span> a_spans;
+    std::vector<Span> b_spans;
+    std::vector<Span> spans;
+    for (size_t i = 0; i + 1 < edges.size(); ++i) {
+        int y1 = edges[i];
+        int y2 = edges[i + 1];
+        a.GetSpansAt(y1, a_index, a_spans);
+        b.GetSpansAt(y1, b_index, b_spans);
+        CombineSpans(a_spans, b_spans, operation, spans);
+        if (!spans.empty()) {
+            result.AppendBand(y1, y2, spans, last_band_start);
+        }
+    }
+
+    result.UpdateBounds();
+    return result;
+}
+
+void Region::CombineSpans(const std::vector<Span>& a, const std::vector<Span>& b,
+                          Operation operation, std::vector<Span>& out) {
+    out.clear();
+    size_t i = 0;
+    size_t j = 0;
+
+    switch (operation) {
+        case Operation::Union:
+            // 按左端归并，重叠或相接的区间合成一个
+            while (i < a.size() || j < b.size()) {
+                const Span& span = (j >= b.size() || (i < a.size() && a[i].x1 <= b[j].x1)) ? a[i++] : b[j++];
+                if (!out.empty() && span.x1 <= out.back().x2) {
+                    out.back().x2 = std::max(out.back().x2, span.x2);
+                } else {
+                    out.push_back(span);
+                }
+            }
+            break;
+
+        case Operation::Intersect:
+            while (i < a.size() && j < b.size()) {
+                int x1 = std::max(a[i].x1, b[j].x1);
+                int x2 = std::min(a[i].x2, b[j].x2);
+                if (x1 < x2) {
+                    out.push_back({ x1, x2 });
+                }
+                if (a[i].x2 < b[j].x2) {
+                    ++i;
+                } else {
+                    ++j;
+                }
+            }
+            break;
+
+        case Operation::Subtract:
+            for (const Span& span : a) {
+                int x = span.x1;
+                while (j < b.size() && b[j].x2 <= x) {
+                    ++j;
+                }
+                for (size_t k = j; k < b.size() && b[k].x1 < span.x2; ++k) {
+                    if (b[k].x1 > x) {
+                        out.push_back({ x, b[k].x1 });
+                    }
+                    x = std::max(x, b[k].x2);
+                }
+                if (x < span.x2) {
+                    out.push_back({ x, span.x2 });
+                }
+            }
+            break;
+    }
+}
+
+void Region::GetSpansAt(int y, size_t& rect_index, std::vector<Span>& spans) const {
+    spans.clear();
+
+    // 跳过完全在y之上的带；调用方按y递增查询，所以下标只会向后走
+    while (rect_index < rects_.size() && rects_[rect_index].y + rects_[rect_index].height <= y) {
+        ++rect_index;
+    }
+    if (rect_index >= rects_.size() || rects_[rect_index].y > y) {
+        return;
+    }
+
+    int band_y = rects_[rect_index].y;
+    for (size_t i = rect_index; i < rects_.size() && rects_[i].y == band_y; ++i) {
+        spans.push_back({ rects_[i].x, rects_[i].x + rects_[i].width });
+    }
+}
+
+void Region::AppendBand(int y1, int y2, const std::vector<Span>& spans, size_t& last_band_start) {
+    if (last_band_start != static_cast<size_t>(-1)) {
+        const Rect& previous = rects_[last_band_start];
+        size_t previous_count = rects_.size() - last_band_start;
+        if (previous.y + previous.height == y1 && previous_count == spans.size()) {
+            bool same = true;
+            for (size_t i = 0; i < spans.size() && same; ++i) {
+                const Rect& rect = rects_[last_band_start + i];
+                same = rect.x == spans[i].x1 && rect.x + rect.width == spans[i].x2;
+            }
+            if (same) {
+                for (size_t i = last_band_start; i < rects_.size(); ++i) {
+                    rects_[i].height += y2 - y1;
+                }
+                return;
+            }
+        }
+    }
+
+    last_band_start = rects_.size();
+    for (const Span& span : spans) {
+        rects_.emplace_back(span.x1, y1, span.x2 - span.x1, y2 - y1);
+    }
+}
+
+void Region::UpdateBounds() {
+    if (rects_.empty()) {
+        bounds_ = Rect(0, 0, 0, 0);
+        return;
+    }
+
+    int left = rects_.front().x;
+    int right = rects_.front().x + rects_.front().width;
+    for (const Rect& rect : rects_) {
+        left = std::min(left, rect.x);
+        right = std::max(right, rect.x + rect.width);
+    }
+    int top = rects_.front().y;
+    int bottom = rects_.back().y + rects_.back().height;
+    bounds_ = Rect(left, top, right - left, bottom - top);
+}
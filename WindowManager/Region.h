@@ -0,0 +1,60 @@
+#pragma once
+#include "Rect.h"
+#include <cstdint>
+#include <vector>
+
+// 由矩形组成的精确区域，按y-x排序的带状表示（与X11/pixman的region相同）：
+// 区域被切成若干水平带，同一带内的矩形上下边相同、按x排序且互不相交；
+// 相邻且内容相同的带会被合并，所以同一区域的表示是唯一的。
+class Region {
+public:
+    Region();
+    explicit Region(const Rect& rect);
+
+    // 多个可能相交的矩形的并集，分治合并，O(n log n)
+    static Region FromRects(const std::vector<Rect>& rects);
+
+    bool IsEmpty() const { return rects_.empty(); }
+    void Clear();
+
+    // 带状矩形列表，互不相交，按y再按x排序
+    const std::vector<Rect>& GetRects() const { return rects_; }
+    Rect GetBounds() const { return bounds_; }
+    int64_t GetArea() const;
+
+    bool Contains(int x, int y) const;
+    bool Intersects(const Rect& rect) const;
+    bool operator==(const Region& other) const;
+    bool operator!=(const Region& other) const { return !(*this == other); }
+
+    // 集合运算，代价与两个区域的带数和每带矩形数成正比
+    Region Union(const Region& other) const;
+    Region Intersect(const Region& other) const;
+    Region Subtract(const Region& other) const;
+
+    Region& UnionWith(const Region& other) { return *this = Union(other); }
+    Region& IntersectWith(const Region& other) { return *this = Intersect(other); }
+    Region& SubtractWith(const Region& other) { return *this = Subtract(other); }
+
+    void Translate(int dx, int dy);
+
+private:
+    enum class Operation { Union, Intersect, Subtract };
+
+    // 水平区间[x1, x2)
+    struct Span {
+        int x1, x2;
+    };
+
+    static Region Combine(const Region& a, const Region& b, Operation operation);
+    static void CombineSpans(const std::vector<Span>& a, const std::vector<Span>& b,
+                             Operation operation, std::vector<Span>& out);
+    // 取出覆盖y的那一带（rect_index从上一次的位置向后推进），不存在时spans为空
+    void GetSpansAt(int y, size_t& rect_index, std::vector<Span>& spans) const;
+    // 追加一带；与上一带相邻且内容相同时只拉长上一带
+    void AppendBand(int y1, int y2, const std::vector<Span>& spans, size_t& last_band_start);
+    void UpdateBounds();
+
+    std::vector<Rect> rects_;
+    Rect bounds_;
+};
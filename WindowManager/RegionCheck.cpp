@@ -0,0 +1,201 @@
+#include "Region.h"
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Region集合运算的检查：随机生成矩形集合，把FromRects、Union、Intersect、Subtract的结果
+// 与逐像素位图上的同一运算比较，并检查结果是否为规范的带状表示。有检查失败时返回非零。
+namespace {
+    // 位图覆盖[kOrigin, kOrigin + kSize)，随机矩形会越过[0, 64)的边界，也会出现空矩形
+    const int kOrigin = -8;
+    const int kSize = 96;
+
+    using Bitmap = std::vector<uint8_t>;
+
+    int failures = 0;
+
+    void Check(bool condition, const char* what, int iteration) {
+        if (!condition) {
+            std::cout << "FAILED: " << what << " (iteration " << iteration << ")" << std::endl;
+            ++failures;
+        }
+    }
+
+    void Fill(Bitmap& bitmap, const Rect& rect) {
+        for (int y = rect.y; y < rect.y + rect.height; ++y) {
+            for (int x = rect.x; x < rect.x + rect.width; ++x) {
+                bitmap[(y - kOrigin) * kSize + (x - kOrigin)] = 1;
+            }
+        }
+    }
+
+    Bitmap Rasterize(const std::vector<Rect>& rects) {
+        Bitmap bitmap(kSize * kSize, 0);
+        for (const Rect& rect : rects) {
+            Fill(bitmap, rect);
+        }
+        return bitmap;
+    }
+
+    int64_t CountPixels(const Bitmap& bitmap) {
+        int64_t count = 0;
+        for (uint8_t pixel : bitmap) {
+            count += pixel;
+        }
+        return count;
+    }
+
+    // 规范形式：矩形非空、按带排序；同一带的矩形上下边相同、按x排序且不相交也不相接；
+    // 上下相接的两带内容必须不同（否则应合并）；边界和面积与矩形一致
+    bool IsCanonical(const Region& region) {
+        const std::vector<Rect>& rects = region.GetRects();
+        size_t band_start = 0;
+        size_t previous_band_start = 0;
+        size_t previous_band_end = 0;
+        int left = 0, top = 0, right = 0, bottom = 0;
+        while (band_start < rects.size()) {
+            size_t band_end = band_start;
+            while (band_end < rects.size() && rects[band_end].y == rects[band_start].y) {
+                const Rect& rect = rects[band_end];
+                if (rect.width <= 0 || rect.height != rects[band_start].height) {
+                    return false;
+                }
+                if (band_end > band_start && rect.x <= rects[band_end - 1].x + rects[band_end - 1].width) {
+                    return false;
+                }
+                ++band_end;
+            }
+
+            const Rect& first = rects[band_start];
+            if (band_start > 0) {
+                const Rect& previous = rects[previous_band_start];
+                if (first.y < previous.y + previous.height) {
+                    return false;
+                }
+                // 相接且内容相同的带应该已经合并
+                if (first.y == previous.y + previous.height && band_end - band_start == previous_band_end - previous_band_start) {
+                    bool same = true;
+                    for (size_t i = 0; i < band_end - band_start; ++i) {
+                        same = same && rects[band_start + i].x == rects[previous_band_start + i].x &&
+                               rects[band_start + i].width == rects[previous_band_start + i].width;
+                    }
+                    if (same) {
+                        return false;
+                    }
+                }
+            }
+
+            const Rect& last = rects[band_end - 1];
+            if (band_start == 0) {
+                left = first.x;
+                top = first.y;
+                right = last.x + last.width;
+            }
+            left = std::min(left, first.x);
+            right = std::max(right, last.x + last.width);
+            bottom = first.y + first.height;
+
+            previous_band_start = band_start;
+            previous_band_end = band_end;
+            band_start = band_end;
+        }
+
+        Rect bounds = region.GetBounds();
+        if (rects.empty()) {
+            return region.IsEmpty() && bounds.width == 0 && bounds.height == 0;
+        }
+        return bounds.x == left && bounds.y == top && bounds.width == right - left && bounds.height == bottom - top;
+    }
+
+    // 像素一致，矩形互不重叠（面积等于像素数），并且是规范形式
+    bool Matches(const Region& region, const Bitmap& expected) {
+        Bitmap actual = Rasterize(region.GetRects());
+        return actual == expected && region.GetArea() == CountPixels(expected) && IsCanonical(region);
+    }
+
+    std::vector<Rect> RandomRects(std::mt19937& rng) {
+        std::uniform_int_distribution<int> count(0, 8);
+        std::uniform_int_distribution<int> position(-4, 60);
+        std::uniform_int_distribution<int> extent(0, 24);
+        std::vector<Rect> rects(count(rng));
+        for (Rect& rect : rects) {
+            rect = Rect(position(rng), position(rng), extent(rng), extent(rng));
+        }
+        return rects;
+    }
+}
+
+int main() {
+    std::cout << "Region check (random rect sets vs per-pixel bitmap)" << std::endl;
+
+    std::mt19937 rng(2024);
+    const int iterations = 2000;
+    for (int i = 0; i < iterations; ++i) {
+        std::vector<Rect> rects_a = RandomRects(rng);
+        std::vector<Rect> rects_b = RandomRects(rng);
+        Bitmap bitmap_a = Rasterize(rects_a);
+        Bitmap bitmap_b = Rasterize(rects_b);
+
+        Region a = Region::FromRects(rects_a);
+        Region b = Region::FromRects(rects_b);
+        Check(Matches(a, bitmap_a), "FromRects", i);
+        Check(Matches(b, bitmap_b), "FromRects", i);
+
+        Bitmap united(bitmap_a.size()), intersected(bitmap_a.size()), subtracted(bitmap_a.size());
+        for (size_t p = 0; p < bitmap_a.size(); ++p) {
+            united[p] = bitmap_a[p] | bitmap_b[p];
+            intersected[p] = bitmap_a[p] & bitmap_b[p];
+            subtracted[p] = bitmap_a[p] & !bitmap_b[p];
+        }
+        Region region_union = a.Union(b);
+        Check(Matches(region_union, united), "Union", i);
+        Check(Matches(a.Intersect(b), intersected), "Intersect", i);
+        Check(Matches(a.Subtract(b), subtracted), "Subtract", i);
+
+        // 表示唯一：同一个像素集合不论怎样得到，operator==都相等
+        Region incremental;
+        for (const Rect& rect : rects_a) {
+            incremental.UnionWith(Region(rect));
+        }
+        Check(incremental == a, "incremental union equals FromRects", i);
+        Check(Region::FromRects(a.GetRects()) == a, "FromRects(GetRects()) round trip", i);
+        Check(b.Union(a) == region_union, "Union is symmetric", i);
+        Check(a.Subtract(b).Union(a.Intersect(b)) == a, "(a - b) + (a & b) == a", i);
+        Check(a.Union(a) == a && a.Intersect(a) == a && a.Subtract(a).IsEmpty(), "self operations", i);
+
+        // 点和矩形查询
+        std::uniform_int_distribution<int> probe(kOrigin, kOrigin + kSize - 1);
+        for (int sample = 0; sample < 16; ++sample) {
+            int x = probe(rng), y = probe(rng);
+            Check(a.Contains(x, y) == (bitmap_a[(y - kOrigin) * kSize + (x - kOrigin)] != 0), "Contains", i);
+        }
+        for (const Rect& rect : rects_b) {
+            bool expected = false;
+            for (int y = rect.y; y < rect.y + rect.height; ++y) {
+                for (int x = rect.x; x < rect.x + rect.width; ++x) {
+                    expected = expected || bitmap_a[(y - kOrigin) * kSize + (x - kOrigin)] != 0;
+                }
+            }
+            Check(a.Intersects(rect) == expected, "Intersects", i);
+        }
+
+        // 平移后与平移过的矩形集合一致
+        Region moved = a;
+        moved.Translate(3, -2);
+        std::vector<Rect> moved_rects = rects_a;
+        for (Rect& rect : moved_rects) {
+            rect.x += 3;
+            rect.y -= 2;
+        }
+        Check(moved == Region::FromRects(moved_rects), "Translate", i);
+
+        if (failures > 20) {
+            break;
+        }
+    }
+
+    std::cout << iterations << " iterations: " << (failures == 0 ? "all checks passed" : "checks FAILED") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
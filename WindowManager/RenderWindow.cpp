@@ -2,10 +2,14 @@
 #include "../Renderer/IRenderer.h"
 #include <memory>
 
-RenderWindow::RenderWindow() : window_(nullptr), renderer_(nullptr), owns_renderer_(false) {
+RenderWindow::RenderWindow() : window_(nullptr), external_window_(nullptr), renderer_(nullptr), owns_renderer_(false),
+                               rendered_width_(-1), rendered_height_(-1) {
 }
 
 RenderWindow::~RenderWindow() {
+    if (window_) {
+        window_->SetEventListener(nullptr);
+    }
     if (owns_renderer_ && renderer_) {
         delete renderer_;
         renderer_ = nullptr;
@@ -14,12 +18,14 @@ RenderWindow::~RenderWindow() {
 
 bool RenderWindow::Initialize(const std::string& name, const std::string& title,
                             int x, int y, int width, int height, 
-                            RendererType renderer_type) {
+                            RendererType renderer_type,
+                            const WindowFactory& factory) {
     // 创建底层窗口
-    window_ = std::make_unique<Win32Window>();
-    if (!window_->Create(title, x, y, width, height)) {
+    window_ = factory ? factory() : nullptr;
+    if (!window_ || !window_->Create(title, x, y, width, height)) {
         return false;
     }
+    window_->SetEventListener(this);
 
     // 创建指定类型的渲染器
     renderer_ = CreateRenderer(renderer_type, window_.get());
@@ -58,6 +64,21 @@ void RenderWindow::Render() {
         return;
     }
     
+    // 隐藏期间不画；再次显示或大小改变后整个窗口重绘
+    if (!win->IsVisible()) {
+        rendered_width_ = -1;
+        rendered_height_ = -1;
+        return;
+    }
+    if (win->GetWidth() != rendered_width_ || win->GetHeight() != rendered_height_) {
+        rendered_width_ = win->GetWidth();
+        rendered_height_ = win->GetHeight();
+        Invalidate();
+    }
+    if (damage_.IsEmpty()) {
+        return;
+    }
+    
     win->BeginRender();
     renderer_->BeginFrame();
     
@@ -66,6 +87,28 @@ void RenderWindow::Render() {
     
     renderer_->EndFrame();
     win->EndRender();
+    win->Present();
+    damage_.Clear();
+}
+
+void RenderWindow::Invalidate() {
+    IWindow* win = GetWindow();
+    if (win) {
+        damage_ = Region(Rect(0, 0, win->GetWidth(), win->GetHeight()));
+    }
+}
+
+void RenderWindow::Invalidate(const Rect& rect) {
+    IWindow* win = GetWindow();
+    if (win) {
+        damage_.UnionWith(Region(rect.GetIntersection(Rect(0, 0, win->GetWidth(), win->GetHeight()))));
+    }
+}
+
+void RenderWindow::OnWindowEvent(IWindow* /*window*/, const WindowEvent& event) {
+    if (event.type == WindowEventType::Expose) {
+        Invalidate(Rect(event.x, event.y, event.width, event.height));
+    }
 }
 
 void RenderWindow::Update() {
@@ -1,6 +1,7 @@
 #pragma once
 #include "IWindow.h"
-#include "Win32Window.h"
+#include "WindowFactory.h"
+#include "Region.h"
 #include <memory>
 #include <string>
 
@@ -15,7 +16,7 @@ enum class RendererType {
     Software
 };
 
-class RenderWindow {
+class RenderWindow : private IWindowEventListener {
 public:
     RenderWindow();
     ~RenderWindow();
@@ -23,14 +24,22 @@ public:
     // 使用指定渲染器类型初始化窗口
     bool Initialize(const std::string& name, const std::string& title,
                    int x, int y, int width, int height, 
-                   RendererType renderer_type);
+                   RendererType renderer_type,
+                   const WindowFactory& factory = CreatePlatformWindow);
 
     // 使用现有窗口和指定渲染器类型初始化
     bool InitializeWithExistingWindow(IWindow* window, RendererType renderer_type);
 
-    // 执行渲染
+    // 执行渲染；没有损坏区域时直接返回
     void Render();
 
+    // 标记需要重绘的区域（客户区坐标）。首次显示、缩放和系统要求重绘（Expose）时自动失效
+    void Invalidate();
+    void Invalidate(const Rect& rect);
+    bool NeedsRender() const { return !damage_.IsEmpty(); }
+    // 本次Render要重绘的区域
+    const Region& GetDamageRegion() const { return damage_; }
+
     // 更新窗口
     void Update();
 
@@ -54,9 +63,14 @@ public:
 private:
     IRenderer* CreateRenderer(RendererType type, IWindow* window);
 
-    std::unique_ptr<Win32Window> window_;  // 底层窗口（如果拥有）
+    // 只监听自己拥有的窗口，外部窗口的监听者通常是WindowManager；大小变化在Render中检测
+    void OnWindowEvent(IWindow* window, const WindowEvent& event) override;
+
+    std::unique_ptr<IWindow> window_;      // 底层窗口（如果拥有）
     IWindow* external_window_;             // 外部窗口（如果不拥有）
     IRenderer* renderer_;                  // 渲染器
     std::string name_;                     // 窗口名称
     bool owns_renderer_;                   // 是否拥有渲染器
+    Region damage_;                        // 待重绘区域
+    int rendered_width_, rendered_height_; // 上一次渲染时的大小，隐藏后为-1
 };
\ No newline at end of file
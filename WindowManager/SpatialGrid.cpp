@@ -0,0 +1,154 @@
+#include "SpatialGrid.h"
+
+namespace {
+    // 向下取整的整数除法，负坐标的窗口也能落到正确的格子
+    int FloorDiv(int value, int divisor) {
+        int quotient = value / divisor;
+        if ((value % divisor != 0) && ((value < 0) != (divisor < 0))) {
+            --quotient;
+        }
+        return quotient;
+    }
+}
+
+SpatialGrid::SpatialGrid(int cell_size) : cell_size_(std::max(cell_size, 1)), query_stamp_(0) {
+}
+
+void SpatialGrid::Insert(uint32_t id, const Rect& rect) {
+    if (id >= rects_.size()) {
+        rects_.resize(id + 1);
+        present_.resize(id + 1, false);
+        query_marks_.resize(id + 1, 0);
+    }
+    if (present_[id]) {
+        Update(id, rect);
+        return;
+    }
+
+    rects_[id] = rect;
+    present_[id] = true;
+    AddToCells(id, rect);
+}
+
+void SpatialGrid::Update(uint32_t id, const Rect& rect) {
+    if (id >= rects_.size() || !present_[id]) {
+        Insert(id, rect);
+        return;
+    }
+
+    int old_x0 = 0, old_y0 = 0, old_x1 = -1, old_y1 = -1;
+    int new_x0 = 0, new_y0 = 0, new_x1 = -1, new_y1 = -1;
+    GetCellRange(rects_[id], old_x0, old_y0, old_x1, old_y1);
+    GetCellRange(rect, new_x0, new_y0, new_x1, new_y1);
+
+    // 小幅移动通常不跨格子，此时不需要改动格子列表
+    if (old_x0 != new_x0 || old_y0 != new_y0 || old_x1 != new_x1 || old_y1 != new_y1) {
+        RemoveFromCells(id, rects_[id]);
+        AddToCells(id, rect);
+    }
+    rects_[id] = rect;
+}
+
+void SpatialGrid::Remove(uint32_t id) {
+    if (id >= rects_.size() || !present_[id]) {
+        return;
+    }
+
+    RemoveFromCells(id, rects_[id]);
+    present_[id] = false;
+}
+
+void SpatialGrid::Clear() {
+    cells_.clear();
+    rects_.clear();
+    present_.clear();
+    query_marks_.clear();
+    query_stamp_ = 0;
+}
+
+void SpatialGrid::Query(const Rect& area, std::vector<uint32_t>& out) const {
+    int x0, y0, x1, y1;
+    if (!GetCellRange(area, x0, y0, x1, y1)) {
+        return;
+    }
+
+    if (++query_stamp_ == 0) {
+        // 序号回绕时清空标记，避免把旧标记误认为本次查询
+        std::fill(query_marks_.begin(), query_marks_.end(), 0);
+        query_stamp_ = 1;
+    }
+
+    for (int cell_y = y0; cell_y <= y1; ++cell_y) {
+        for (int cell_x = x0; cell_x <= x1; ++cell_x) {
+            auto it = cells_.find(CellKey(cell_x, cell_y));
+            if (it == cells_.end()) {
+                continue;
+            }
+            for (uint32_t id : it->second) {
+                if (query_marks_[id] == query_stamp_) {
+                    continue;
+                }
+                query_marks_[id] = query_stamp_;
+                if (rects_[id].Intersects(area)) {
+                    out.push_back(id);
+                }
+            }
+        }
+    }
+}
+
+bool SpatialGrid::GetCellRange(const Rect& rect, int& x0, int& y0, int& x1, int& y1) const {
+    if (rect.width <= 0 || rect.height <= 0) {
+        return false;
+    }
+
+    x0 = FloorDiv(rect.x, cell_size_);
+    y0 = FloorDiv(rect.y, cell_size_);
+    x1 = FloorDiv(rect.x + rect.width - 1, cell_size_);
+    y1 = FloorDiv(rect.y + rect.height - 1, cell_size_);
+    return true;
+}
+
+void SpatialGrid::AddToCells(uint32_t id, const Rect& rect) {
+    int x0, y0, x1, y1;
+    if (!GetCellRange(rect, x0, y0, x1, y1)) {
+        return;
+    }
+
+    for (int cell_y = y0; cell_y <= y1; ++cell_y) {
+        for (int cell_x = x0; cell_x <= x1; ++cell_x) {
+            cells_[CellKey(cell_x, cell_y)].push_back(id);
+        }
+    }
+}
+
+void SpatialGrid::RemoveFromCells(uint32_t id, const Rect& rect) {
+    int x0, y0, x1, y1;
+    if (!GetCellRange(rect, x0, y0, x1, y1)) {
+        return;
+    }
+
+    for (int cell_y = y0; cell_y <= y1; ++cell_y) {
+        for (int cell_x = x0; cell_x <= x1; ++cell_x) {
+            auto it = cells_.find(CellKey(cell_x, cell_y));
+            if (it == cells_.end()) {
+                continue;
+            }
+            std::vector<uint32_t>& ids = it->second;
+            for (size_t i = 0; i < ids.size(); ++i) {
+                if (ids[i] == id) {
+                    ids[i] = ids.back();
+                    ids.pop_back();
+                    break;
+                }
+            }
+            if (ids.empty()) {
+                cells_.erase(it);
+            }
+        }
+    }
+}
+
+uint64_t SpatialGrid::CellKey(int cell_x, int cell_y) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(cell_x)) << 32) | static_cast<uint32_t>(cell_y);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "Rect.h"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// 均匀网格空间索引：每个条目登记在它覆盖的所有格子里，查询只访问与查询区域相交的格子，
+// 代价与覆盖的格子数和结果数成正比，而不是与条目总数成正比。
+// 条目用调用者分配的id标识（应尽量紧凑，内部按id建数组）。
+class SpatialGrid {
+public:
+    explicit SpatialGrid(int cell_size = 256);
+
+    // 插入、更新、删除条目；Update在格子范围不变时只改矩形
+    void Insert(uint32_t id, const Rect& rect);
+    void Update(uint32_t id, const Rect& rect);
+    void Remove(uint32_t id);
+    void Clear();
+
+    // 把与area相交的条目id追加到out，每个id只出现一次，顺序不定
+    void Query(const Rect& area, std::vector<uint32_t>& out) const;
+
+    int GetCellSize() const { return cell_size_; }
+    size_t GetOccupiedCellCount() const { return cells_.size(); }
+
+private:
+    // 矩形覆盖的格子范围（闭区间），矩形为空时返回false
+    bool GetCellRange(const Rect& rect, int& x0, int& y0, int& x1, int& y1) const;
+    void AddToCells(uint32_t id, const Rect& rect);
+    void RemoveFromCells(uint32_t id, const Rect& rect);
+    static uint64_t CellKey(int cell_x, int cell_y);
+
+    int cell_size_;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells_;
+    std::vector<Rect> rects_;        // 按id存放的条目矩形
+    std::vector<bool> present_;
+
+    // 查询去重：条目被访问时记下本次查询的序号，避免为每次查询清空标记
+    mutable std::vector<uint32_t> query_marks_;
+    mutable uint32_t query_stamp_;
+};
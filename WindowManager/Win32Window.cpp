@@ -6,7 +6,8 @@
 ATOM Win32Window::window_class_atom_ = 0;
 const char* Win32Window::kWindowClassName = "GameEngineWindowClass";
 
-Win32Window::Win32Window() : hwnd_(nullptr), visible_(false), valid_(false) {
+Win32Window::Win32Window()
+    : hwnd_(nullptr), visible_(false), valid_(false), x_(0), y_(0), width_(0), height_(0), listener_(nullptr) {
 }
 
 Win32Window::~Win32Window() {
@@ -52,6 +53,7 @@ bool Win32Window::Create(const std::string& title, int x, int y, int width, int
 
     SetWindowLongPtr(hwnd_, GWLP_USERDATA, reinterpret_cast<LONG_PTR>(this));
     valid_ = true;
+    RefreshGeometry();
     return true;
 }
 
@@ -106,15 +108,15 @@ std::string Win32Window::GetTitle() const {
 void Win32Window::SetPosition(int x, int y) {
     if (valid_ && hwnd_) {
         SetWindowPos(hwnd_, nullptr, x, y, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
+        // SetWindowPos同步发送WM_MOVE，这里再刷新一次以防窗口过程没有收到
+        RefreshGeometry();
     }
 }
 
 void Win32Window::GetPosition(int& x, int& y) const {
     if (valid_ && hwnd_) {
-        RECT rect;
-        GetWindowRect(hwnd_, &rect);
-        x = rect.left;
-        y = rect.top;
+        x = x_;
+        y = y_;
     }
 }
 
@@ -128,40 +130,76 @@ void Win32Window::SetSize(int width, int height) {
 
         SetWindowPos(hwnd_, nullptr, 0, 0, window_width, window_height, 
                      SWP_NOMOVE | SWP_NOZORDER);
+        RefreshGeometry();
     }
 }
 
 void Win32Window::GetSize(int& width, int& height) const {
     if (valid_ && hwnd_) {
-        RECT client_rect;
-        GetClientRect(hwnd_, &client_rect);
-        width = client_rect.right - client_rect.left;
-        height = client_rect.bottom - client_rect.top;
+        width = width_;
+        height = height_;
     }
 }
 
 int Win32Window::GetX() const {
-    int x, y;
-    GetPosition(x, y);
-    return x;
+    return x_;
 }
 
 int Win32Window::GetY() const {
-    int x, y;
-    GetPosition(x, y);
-    return y;
+    return y_;
 }
 
 int Win32Window::GetWidth() const {
-    int width, height;
-    GetSize(width, height);
-    return width;
+    return width_;
 }
 
 int Win32Window::GetHeight() const {
-    int width, height;
-    GetSize(width, height);
-    return height;
+    return height_;
+}
+
+void Win32Window::SetEventListener(IWindowEventListener* listener) {
+    listener_ = listener;
+}
+
+void Win32Window::RefreshGeometry() {
+    if (!hwnd_) {
+        return;
+    }
+
+    RECT window_rect;
+    RECT client_rect;
+    GetWindowRect(hwnd_, &window_rect);
+    GetClientRect(hwnd_, &client_rect);
+
+    int x = window_rect.left;
+    int y = window_rect.top;
+    int width = client_rect.right - client_rect.left;
+    int height = client_rect.bottom - client_rect.top;
+    if (x == x_ && y == y_ && width == width_ && height == height_) {
+        return;
+    }
+
+    x_ = x;
+    y_ = y;
+    width_ = width;
+    height_ = height;
+    if (listener_) {
+        listener_->OnWindowGeometryChanged(this, x_, y_, width_, height_);
+    }
+}
+
+void Win32Window::NotifyEvent(WindowEventType type, int x, int y, int width, int height, int code) {
+    if (listener_) {
+        WindowEvent event = {};
+        event.type = type;
+        event.x = x;
+        event.y = y;
+        event.width = width;
+        event.height = height;
+        event.code = code;
+        event.timestamp_ns = GetWindowEventTimestamp();
+        listener_->OnWindowEvent(this, event);
+    }
 }
 
 void* Win32Window::GetNativeHandle() {
@@ -178,6 +216,10 @@ void Win32Window::EndRender() {
     // 例如：交换缓冲区等
 }
 
+void Win32Window::Present() {
+    // 缓冲区交换由渲染器完成，这里只是呈现阶段的挂接点
+}
+
 LRESULT CALLBACK Win32Window::WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam) {
     Win32Window* window = nullptr;
 
@@ -194,8 +236,56 @@ LRESULT CALLBACK Win32Window::WndProc(HWND hwnd, UINT message, WPARAM wParam, LP
             case WM_DESTROY:
                 PostQuitMessage(0);
                 return 0;
+            case WM_ACTIVATE:
+                // 窗口被激活时通知监听者，然后交给默认处理设置焦点
+                if (LOWORD(wParam) != WA_INACTIVE && window->listener_) {
+                    window->listener_->OnWindowActivated(window);
+                    window->NotifyEvent(WindowEventType::Activate, 0, 0, 0, 0, 0);
+                }
+                break;
+            case WM_MOVE:
+                // 窗口移动或大小改变，更新缓存的几何信息
+                window->RefreshGeometry();
+                window->NotifyEvent(WindowEventType::Move, window->x_, window->y_, 0, 0, 0);
+                return 0;
             case WM_SIZE:
-                // 窗口大小改变
+                window->RefreshGeometry();
+                window->NotifyEvent(WindowEventType::Resize, 0, 0, window->width_, window->height_, 0);
+                return 0;
+            case WM_SHOWWINDOW:
+                window->NotifyEvent(wParam ? WindowEventType::Show : WindowEventType::Hide, 0, 0, 0, 0, 0);
+                break;
+            case WM_CLOSE:
+                window->NotifyEvent(WindowEventType::Close, 0, 0, 0, 0, 0);
+                break;
+            case WM_KEYDOWN:
+            case WM_KEYUP:
+                window->NotifyEvent(message == WM_KEYDOWN ? WindowEventType::KeyDown : WindowEventType::KeyUp,
+                                    0, 0, 0, 0, static_cast<int>(wParam));
+                break;
+            case WM_MOUSEMOVE:
+            case WM_LBUTTONDOWN:
+            case WM_LBUTTONUP:
+            case WM_RBUTTONDOWN:
+            case WM_RBUTTONUP:
+            case WM_MBUTTONDOWN:
+            case WM_MBUTTONUP:
+                {
+                    // 坐标是有符号的16位值，窗口外拖动时可能为负
+                    int mouse_x = static_cast<short>(LOWORD(lParam));
+                    int mouse_y = static_cast<short>(HIWORD(lParam));
+                    WindowEventType type = WindowEventType::MouseMove;
+                    int button = 0;
+                    switch (message) {
+                        case WM_LBUTTONDOWN: type = WindowEventType::MouseDown; button = 0; break;
+                        case WM_LBUTTONUP:   type = WindowEventType::MouseUp;   button = 0; break;
+                        case WM_RBUTTONDOWN: type = WindowEventType::MouseDown; button = 1; break;
+                        case WM_RBUTTONUP:   type = WindowEventType::MouseUp;   button = 1; break;
+                        case WM_MBUTTONDOWN: type = WindowEventType::MouseDown; button = 2; break;
+                        case WM_MBUTTONUP:   type = WindowEventType::MouseUp;   button = 2; break;
+                    }
+                    window->NotifyEvent(type, mouse_x, mouse_y, 0, 0, button);
+                }
                 return 0;
             case WM_PAINT:
                 // 处理绘制消息
@@ -203,6 +293,9 @@ LRESULT CALLBACK Win32Window::WndProc(HWND hwnd, UINT message, WPARAM wParam, LP
                     PAINTSTRUCT ps;
                     HDC hdc = BeginPaint(hwnd, &ps);
                     EndPaint(hwnd, &ps);
+                    // 系统要求重绘的区域交给监听者，由渲染器在下一帧重绘
+                    window->NotifyEvent(WindowEventType::Expose, ps.rcPaint.left, ps.rcPaint.top,
+                                        ps.rcPaint.right - ps.rcPaint.left, ps.rcPaint.bottom - ps.rcPaint.top, 0);
                 }
                 return 0;
         }
@@ -28,9 +28,12 @@ public:
     int GetWidth() const override;
     int GetHeight() const override;
 
+    void SetEventListener(IWindowEventListener* listener) override;
+
     void* GetNativeHandle() override;
     void BeginRender() override;
     void EndRender() override;
+    void Present() override;
 
     // Windows特定功能
     HWND GetHwnd() const { return hwnd_; }
@@ -39,11 +42,19 @@ private:
     static LRESULT CALLBACK WndProc(HWND hwnd, UINT message, WPARAM wParam, LPARAM lParam);
     void RegisterWindowClass();
     void UnregisterWindowClass();
+    // 重新读取窗口矩形和客户区大小，只在创建、移动和缩放时调用
+    void RefreshGeometry();
+    // 把消息归一化为WindowEvent交给监听者
+    void NotifyEvent(WindowEventType type, int x, int y, int width, int height, int code);
 
     HWND hwnd_;
     std::string title_;
     bool visible_;
     bool valid_;
+    // 缓存的几何信息：位置为窗口矩形左上角，大小为客户区大小
+    int x_, y_;
+    int width_, height_;
+    IWindowEventListener* listener_;
     static ATOM window_class_atom_;
     static const char* kWindowClassName;
 };
\ No newline at end of file
@@ -0,0 +1,37 @@
+#pragma once
+#include "WindowHandle.h"
+#include <chrono>
+#include <cstdint>
+
+// 窗口事件类型
+enum class WindowEventType {
+    None,
+    Move,         // x, y 为新位置
+    Resize,       // width, height 为新的客户区大小
+    Show,
+    Hide,
+    Close,
+    Activate,
+    Expose,       // x, y, width, height 为需要重绘的客户区矩形
+    KeyDown,      // code 为键码
+    KeyUp,
+    MouseMove,    // x, y 为客户区坐标
+    MouseDown,    // code 为鼠标按键
+    MouseUp
+};
+
+// 窗口事件（可平凡复制，可直接按值复制和放入环形队列）
+struct WindowEvent {
+    WindowEventType type;
+    int x, y;
+    int width, height;
+    int code;
+    WindowHandle window;     // 由WindowManager在入队时填写
+    int64_t timestamp_ns;    // 事件产生时的单调时钟时间，0表示由入队方补上；用于测量输入延迟
+};
+
+// 与WindowEvent::timestamp_ns相同时间基准的当前时间
+inline int64_t GetWindowEventTimestamp() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
@@ -0,0 +1,58 @@
+#include "WindowEventQueue.h"
+#include <algorithm>
+
+namespace {
+    size_t RoundUpToPowerOfTwo(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+WindowEventQueue::WindowEventQueue(size_t capacity)
+    : buffer_(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 2))), mask_(buffer_.size() - 1),
+      head_(0), cached_tail_(0), tail_(0), cached_head_(0), dropped_(0) {
+}
+
+bool WindowEventQueue::Push(const WindowEvent& event) {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - cached_head_ == buffer_.size()) {
+        cached_head_ = head_.load(std::memory_order_acquire);
+        if (tail - cached_head_ == buffer_.size()) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+    }
+
+    buffer_[tail & mask_] = event;
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool WindowEventQueue::Pop(WindowEvent& event) {
+    return PopBatch(&event, 1) == 1;
+}
+
+size_t WindowEventQueue::PopBatch(WindowEvent* out, size_t max_count) {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (cached_tail_ - head < max_count) {
+        cached_tail_ = tail_.load(std::memory_order_acquire);
+    }
+
+    size_t count = std::min(cached_tail_ - head, max_count);
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = buffer_[(head + i) & mask_];
+    }
+    if (count > 0) {
+        head_.store(head + count, std::memory_order_release);
+    }
+    return count;
+}
+
+size_t WindowEventQueue::GetSize() const {
+    // 先读head_，保证读到的tail_不小于它
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "WindowEvent.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 单生产者单消费者的无锁环形队列。
+// 生产者和消费者各自只写自己的下标，并缓存对方的下标，只有缓存值显示队列满/空时才读取对方的原子变量，
+// 两个下标放在不同的缓存行上，避免伪共享。队列满时Push立即失败并计入丢弃数，生产者永远不会阻塞。
+class WindowEventQueue {
+public:
+    // 容量向上取整为2的幂
+    explicit WindowEventQueue(size_t capacity = 4096);
+
+    WindowEventQueue(const WindowEventQueue&) = delete;
+    WindowEventQueue& operator=(const WindowEventQueue&) = delete;
+
+    // 只能在生产者线程调用
+    bool Push(const WindowEvent& event);
+
+    // 只能在消费者线程调用。Pop在队列为空时返回false；PopBatch最多取出max_count个事件，返回取出的事件数
+    bool Pop(WindowEvent& event);
+    size_t PopBatch(WindowEvent* out, size_t max_count);
+
+    // 其他线程调用时只是近似值
+    size_t GetSize() const;
+    size_t GetCapacity() const { return buffer_.size(); }
+    uint64_t GetDroppedCount() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    std::vector<WindowEvent> buffer_;
+    size_t mask_;
+
+    alignas(64) std::atomic<size_t> head_;   // 下一个读取位置，只由消费者写
+    size_t cached_tail_;                     // 消费者看到的tail_
+    alignas(64) std::atomic<size_t> tail_;   // 下一个写入位置，只由生产者写
+    size_t cached_head_;                     // 生产者看到的head_
+    std::atomic<uint64_t> dropped_;
+};
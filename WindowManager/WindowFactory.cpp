@@ -0,0 +1,17 @@
+#include "WindowFactory.h"
+#include "HeadlessWindow.h"
+#ifdef _WIN32
+#include "Win32Window.h"
+#endif
+
+std::unique_ptr<IWindow> CreatePlatformWindow() {
+#ifdef _WIN32
+    return std::make_unique<Win32Window>();
+#else
+    return std::make_unique<HeadlessWindow>();
+#endif
+}
+
+std::unique_ptr<IWindow> CreateHeadlessWindow() {
+    return std::make_unique<HeadlessWindow>();
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "IWindow.h"
+#include <functional>
+#include <memory>
+
+// 窗口工厂：返回尚未调用Create的窗口对象
+using WindowFactory = std::function<std::unique_ptr<IWindow>()>;
+
+// 当前平台的默认窗口：Windows上为Win32Window，其他平台为HeadlessWindow
+std::unique_ptr<IWindow> CreatePlatformWindow();
+
+// 总是创建HeadlessWindow（用于测试、压测和无窗口系统的环境）
+std::unique_ptr<IWindow> CreateHeadlessWindow();
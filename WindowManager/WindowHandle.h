@@ -0,0 +1,18 @@
+#pragma once
+#include <cstdint>
+
+// 窗口句柄：槽位下标加代数。窗口销毁后槽位会被复用，但代数随之加一，
+// 旧句柄不会指向新窗口，查找时比较代数即可判断句柄是否过期
+struct WindowHandle {
+    uint32_t index;
+    uint32_t generation;   // 0表示无效句柄
+
+    WindowHandle() : index(0), generation(0) {}
+    WindowHandle(uint32_t index, uint32_t generation) : index(index), generation(generation) {}
+
+    bool IsValid() const { return generation != 0; }
+    bool operator==(const WindowHandle& other) const {
+        return index == other.index && generation == other.generation;
+    }
+    bool operator!=(const WindowHandle& other) const { return !(*this == other); }
+};
@@ -1,14 +1,26 @@
 #include "WindowManager.h"
-#include "Win32Window.h"
 #include <algorithm>
-#include <iostream>
+#include <chrono>
+#ifdef _WIN32
+#include <windows.h>
+// windows.h把CreateWindow定义为宏，会改掉下面成员函数的名字
+#undef CreateWindow
+#endif
 
-WindowManager::WindowManager() : running_(true) {
+WindowManager::WindowManager(WindowFactory factory)
+    : top_z_(0), bottom_z_(0), layout_dirty_(false), render_stats_(), window_factory_(std::move(factory)), running_(true),
+      window_grid_(256), render_threads_(1), frame_timings_(), frame_pacer_(60.0),
+      event_queue_(4096), event_latencies_ms_(4096, 0.0), event_latency_next_(0), events_polled_(0) {
 }
 
 WindowManager::~WindowManager() {
     // 销毁所有窗口
-    windows_.clear();
+    for (auto& slot : slots_) {
+        if (slot.window) {
+            slot.window->SetEventListener(nullptr);
+        }
+    }
+    slots_.clear();
 }
 
 IWindow* WindowManager::CreateWindow(const std::string& name, const std::string& title, 
@@ -19,82 +31,115 @@ IWindow* WindowManager::CreateWindow(const std::string& name, const std::string&
     }
 
     // 创建新窗口
-    auto window = std::make_unique<Win32Window>();
-    if (!window->Create(title, x, y, width, height)) {
+    std::unique_ptr<IWindow> window = window_factory_ ? window_factory_() : nullptr;
+    if (!window || !window->Create(title, x, y, width, height)) {
         return nullptr; // 创建失败
     }
 
     IWindow* window_ptr = window.get();
-    windows_[name] = std::move(window);
+    uint32_t slot = AllocateSlot();
+    slots_[slot].window = std::move(window);
+    slots_[slot].name = name;
+    name_index_[name] = slot;
+    window_slot_index_[window_ptr] = slot;
+    AddWindowRect(slot);
+    window_ptr->SetEventListener(this);
     return window_ptr;
 }
 
 bool WindowManager::DestroyWindow(const std::string& name) {
-    auto it = windows_.find(name);
-    if (it != windows_.end()) {
-        it->second->Destroy();
-        windows_.erase(it);
+    auto it = name_index_.find(name);
+    if (it != name_index_.end()) {
+        DestroySlot(it->second);
         return true;
     }
     return false;
 }
 
 bool WindowManager::DestroyWindow(IWindow* window) {
-    if (!window) {
-        return false;
+    auto it = window_slot_index_.find(window);
+    if (it != window_slot_index_.end()) {
+        DestroySlot(it->second);
+        return true;
     }
+    return false;
+}
 
-    for (auto it = windows_.begin(); it != windows_.end(); ++it) {
-        if (it->second.get() == window) {
-            window->Destroy();
-            windows_.erase(it);
-            return true;
-        }
+bool WindowManager::DestroyWindow(WindowHandle handle) {
+    int slot = FindSlot(handle);
+    if (slot >= 0) {
+        DestroySlot(static_cast<uint32_t>(slot));
+        return true;
     }
     return false;
 }
 
 IWindow* WindowManager::GetWindow(const std::string& name) const {
-    auto it = windows_.find(name);
-    if (it != windows_.end()) {
-        return it->second.get();
+    auto it = name_index_.find(name);
+    if (it != name_index_.end()) {
+        return slots_[it->second].window.get();
     }
     return nullptr;
 }
 
+IWindow* WindowManager::GetWindow(WindowHandle handle) const {
+    int slot = FindSlot(handle);
+    return slot >= 0 ? slots_[slot].window.get() : nullptr;
+}
+
+WindowHandle WindowManager::GetWindowHandle(IWindow* window) const {
+    auto it = window_slot_index_.find(window);
+    if (it != window_slot_index_.end()) {
+        return WindowHandle(it->second, slots_[it->second].generation);
+    }
+    return WindowHandle();
+}
+
+WindowHandle WindowManager::GetWindowHandle(const std::string& name) const {
+    auto it = name_index_.find(name);
+    if (it != name_index_.end()) {
+        return WindowHandle(it->second, slots_[it->second].generation);
+    }
+    return WindowHandle();
+}
+
+bool WindowManager::IsValidHandle(WindowHandle handle) const {
+    return FindSlot(handle) >= 0;
+}
+
 void WindowManager::UpdateAllWindows() {
-    for (auto& pair : windows_) {
-        pair.second->Update();
+    for (IWindow* window : window_rect_owners_) {
+        window->Update();
     }
 }
 
 void WindowManager::ShowAllWindows() {
-    for (auto& pair : windows_) {
-        pair.second->Show();
+    for (IWindow* window : window_rect_owners_) {
+        window->Show();
     }
 }
 
 void WindowManager::HideAllWindows() {
-    for (auto& pair : windows_) {
-        pair.second->Hide();
+    for (IWindow* window : window_rect_owners_) {
+        window->Hide();
     }
 }
 
 size_t WindowManager::GetWindowCount() const {
-    return windows_.size();
+    return window_rect_owners_.size();
 }
 
 std::vector<std::string> WindowManager::GetWindowNames() const {
     std::vector<std::string> names;
-    names.reserve(windows_.size());
-    for (const auto& pair : windows_) {
-        names.push_back(pair.first);
+    names.reserve(window_slots_.size());
+    for (uint32_t slot : window_slots_) {
+        names.push_back(slots_[slot].name);
     }
     return names;
 }
 
 bool WindowManager::HasWindow(const std::string& name) const {
-    return windows_.find(name) != windows_.end();
+    return name_index_.find(name) != name_index_.end();
 }
 
 void WindowManager::ProcessMessages() {
@@ -111,30 +156,182 @@ void WindowManager::ProcessMessages() {
 #endif
 }
 
+void WindowManager::OnWindowEvent(IWindow* window, const WindowEvent& event) {
+    if (event.type == WindowEventType::Expose) {
+        Invalidate(window, Rect(event.x, event.y, event.width, event.height));
+    }
+    
+    WindowEvent queued = event;
+    queued.window = GetWindowHandle(window);
+    if (queued.timestamp_ns == 0) {
+        queued.timestamp_ns = GetWindowEventTimestamp();
+    }
+    event_queue_.Push(queued);
+}
+
+size_t WindowManager::PollEvents(WindowEvent* out, size_t max_count) {
+    size_t count = event_queue_.PopBatch(out, max_count);
+    if (count == 0) {
+        return 0;
+    }
+
+    // 一批事件共用一次取时间
+    int64_t now = GetWindowEventTimestamp();
+    for (size_t i = 0; i < count; ++i) {
+        event_latencies_ms_[event_latency_next_] = (now - out[i].timestamp_ns) / 1e6;
+        event_latency_next_ = (event_latency_next_ + 1) % event_latencies_ms_.size();
+    }
+    events_polled_ += count;
+    return count;
+}
+
+WindowEventLatencyStats WindowManager::GetEventLatencyStats() const {
+    WindowEventLatencyStats stats = {};
+    stats.events = events_polled_;
+    stats.dropped = event_queue_.GetDroppedCount();
+
+    size_t recorded = static_cast<size_t>(std::min<uint64_t>(events_polled_, event_latencies_ms_.size()));
+    if (recorded == 0) {
+        return stats;
+    }
+
+    std::vector<double> sorted(event_latencies_ms_.begin(), event_latencies_ms_.begin() + recorded);
+    std::sort(sorted.begin(), sorted.end());
+    double total = 0.0;
+    for (double latency : sorted) {
+        total += latency;
+    }
+    stats.average_ms = total / sorted.size();
+    stats.p50_ms = sorted[(sorted.size() - 1) / 2];
+    stats.p99_ms = sorted[std::min(sorted.size() - 1, sorted.size() * 99 / 100)];
+    stats.max_ms = sorted.back();
+    return stats;
+}
+
 void WindowManager::Exit() {
     running_ = false;
-    // 销毁所有窗口
-    for (auto& pair : windows_) {
-        pair.second->Destroy();
+    // 销毁所有窗口；逐个释放槽位，保证退出前拿到的句柄都会失效
+    while (!window_slots_.empty()) {
+        DestroySlot(window_slots_.back());
+    }
+}
+
+uint32_t WindowManager::AllocateSlot() {
+    if (!free_slots_.empty()) {
+        uint32_t slot = free_slots_.back();
+        free_slots_.pop_back();
+        return slot;
+    }
+
+    slots_.emplace_back();
+    slots_.back().generation = 1;
+    slots_.back().dense_index = 0;
+    return static_cast<uint32_t>(slots_.size() - 1);
+}
+
+void WindowManager::DestroySlot(uint32_t slot) {
+    WindowSlot& entry = slots_[slot];
+    IWindow* window = entry.window.get();
+    window->SetEventListener(nullptr);
+    RemoveWindowRect(slot);
+    frame_pacer_.RemoveRate(slot);
+    window->Destroy();
+    
+    name_index_.erase(entry.name);
+    window_slot_index_.erase(window);
+    entry.window.reset();
+    entry.name.clear();
+    // 代数回绕时跳过0，0留给无效句柄
+    if (++entry.generation == 0) {
+        entry.generation = 1;
+    }
+    free_slots_.push_back(slot);
+}
+
+int WindowManager::FindSlot(WindowHandle handle) const {
+    if (handle.index >= slots_.size()) {
+        return -1;
+    }
+    const WindowSlot& entry = slots_[handle.index];
+    if (entry.generation != handle.generation || !entry.window) {
+        return -1;
+    }
+    return static_cast<int>(handle.index);
+}
+
+void WindowManager::OnWindowGeometryChanged(IWindow* window, int x, int y, int width, int height) {
+    int index = FindWindowRect(window);
+    if (index >= 0) {
+        // 大小改变后整个窗口都要重绘；只是移动时内容不变，露出部分的变化在渲染时计算
+        if (width != window_rects_[index].width || height != window_rects_[index].height) {
+            window_damage_[index] = Region(Rect(0, 0, width, height));
+        }
+        window_rects_[index] = Rect(x, y, width, height);
+        window_grid_.Update(static_cast<uint32_t>(index), window_rects_[index]);
+        layout_dirty_ = true;
     }
-    windows_.clear();
+}
+
+void WindowManager::AddWindowRect(uint32_t slot) {
+    IWindow* window = slots_[slot].window.get();
+    slots_[slot].dense_index = static_cast<uint32_t>(window_rects_.size());
+    window_rects_.emplace_back(window->GetX(), window->GetY(), window->GetWidth(), window->GetHeight());
+    window_rect_owners_.push_back(window);
+    window_slots_.push_back(slot);
+    window_z_.push_back(++top_z_);
+    window_damage_.emplace_back(Rect(0, 0, window->GetWidth(), window->GetHeight()));
+    window_exposed_.emplace_back();
+    window_visible_.push_back(0);
+    window_grid_.Insert(static_cast<uint32_t>(window_rects_.size() - 1), window_rects_.back());
+    layout_dirty_ = true;
+}
+
+void WindowManager::RemoveWindowRect(uint32_t slot) {
+    size_t index = slots_[slot].dense_index;
+
+    // 用末尾元素填补空位，保持数组连续；网格里的id随之从last改为index
+    size_t last = window_rects_.size() - 1;
+    window_grid_.Remove(static_cast<uint32_t>(index));
+    if (index != last) {
+        window_grid_.Remove(static_cast<uint32_t>(last));
+        window_grid_.Insert(static_cast<uint32_t>(index), window_rects_[last]);
+        window_rects_[index] = window_rects_[last];
+        window_rect_owners_[index] = window_rect_owners_[last];
+        window_slots_[index] = window_slots_[last];
+        window_z_[index] = window_z_[last];
+        window_damage_[index] = std::move(window_damage_[last]);
+        window_exposed_[index] = std::move(window_exposed_[last]);
+        window_visible_[index] = window_visible_[last];
+        slots_[window_slots_[index]].dense_index = static_cast<uint32_t>(index);
+    }
+    window_rects_.pop_back();
+    window_rect_owners_.pop_back();
+    window_slots_.pop_back();
+    window_z_.pop_back();
+    window_damage_.pop_back();
+    window_exposed_.pop_back();
+    window_visible_.pop_back();
+    layout_dirty_ = true;
+}
+
+int WindowManager::FindWindowRect(IWindow* window) const {
+    auto it = window_slot_index_.find(window);
+    if (it == window_slot_index_.end()) {
+        return -1;
+    }
+    return static_cast<int>(slots_[it->second].dense_index);
 }
 
 // 检查窗口是否与其他窗口重叠
 bool WindowManager::IsWindowOverlapping(IWindow* window) const {
-    if (!window) return false;
-    
-    Rect window_rect(window->GetX(), window->GetY(), window->GetWidth(), window->GetHeight());
+    int index = FindWindowRect(window);
+    if (index < 0) return false;
     
-    for (const auto& pair : windows_) {
-        IWindow* other_window = pair.second.get();
-        if (other_window != window && other_window->IsVisible()) {
-            Rect other_rect(other_window->GetX(), other_window->GetY(), 
-                           other_window->GetWidth(), other_window->GetHeight());
-            
-            if (window_rect.Intersects(other_rect)) {
-                return true;
-            }
+    grid_query_results_.clear();
+    window_grid_.Query(window_rects_[index], grid_query_results_);
+    for (uint32_t other : grid_query_results_) {
+        if (static_cast<int>(other) != index && window_rect_owners_[other]->IsVisible()) {
+            return true;
         }
     }
     return false;
@@ -142,85 +339,311 @@ bool WindowManager::IsWindowOverlapping(IWindow* window) const {
 
 // 获取窗口的重叠区域
 std::vector<Rect> WindowManager::GetOverlappingAreas(IWindow* window) const {
-    std::vector<Rect> overlapping_areas;
-    if (!window) return overlapping_areas;
+    return GetOverlapRegion(window).GetRects();
+}
+
+// 窗口与其他可见窗口的精确重叠区域（各交集的并集，不再取包围盒）
+Region WindowManager::GetOverlapRegion(IWindow* window) const {
+    int index = FindWindowRect(window);
+    if (index < 0) return Region();
     
-    Rect window_rect(window->GetX(), window->GetY(), window->GetWidth(), window->GetHeight());
+    const Rect& window_rect = window_rects_[index];
     
-    for (const auto& pair : windows_) {
-        IWindow* other_window = pair.second.get();
-        if (other_window != window && other_window->IsVisible()) {
-            Rect other_rect(other_window->GetX(), other_window->GetY(), 
-                           other_window->GetWidth(), other_window->GetHeight());
-            
-            Rect intersection = window_rect.GetIntersection(other_rect);
-            if (intersection.width > 0 && intersection.height > 0) {
-                overlapping_areas.push_back(intersection);
-            }
+    // 只检查空间索引给出的候选窗口
+    std::vector<Rect> intersections;
+    grid_query_results_.clear();
+    window_grid_.Query(window_rect, grid_query_results_);
+    for (uint32_t other : grid_query_results_) {
+        if (static_cast<int>(other) != index && window_rect_owners_[other]->IsVisible()) {
+            intersections.push_back(window_rect.GetIntersection(window_rects_[other]));
         }
     }
     
-    // 合并重叠区域（如果它们相交）
-    std::vector<Rect> merged_areas;
-    for (const auto& area : overlapping_areas) {
-        bool merged = false;
-        for (auto& existing : merged_areas) {
-            if (area.Intersects(existing)) {
-                // 合并矩形 - 取包围盒
-                int left = std::min(area.x, existing.x);
-                int top = std::min(area.y, existing.y);
-                int right = std::max(area.x + area.width, existing.x + existing.width);
-                int bottom = std::max(area.y + area.height, existing.y + existing.height);
-                existing = Rect(left, top, right - left, bottom - top);
-                merged = true;
-                break;
-            }
+    return Region::FromRects(intersections);
+}
+
+// 窗口未被上层可见窗口遮挡的部分
+Region WindowManager::GetVisibleRegion(IWindow* window) const {
+    int index = FindWindowRect(window);
+    Region exposed;
+    if (index < 0 || !window->IsVisible()) return exposed;
+    
+    ComputeExposedRegion(static_cast<size_t>(index), exposed);
+    return exposed;
+}
+
+bool WindowManager::ComputeExposedRegion(size_t index, Region& exposed) const {
+    const Rect& window_rect = window_rects_[index];
+    exposed.Clear();
+    if (window_rect.width <= 0 || window_rect.height <= 0) {
+        return false;
+    }
+    
+    // 只有空间索引给出的候选窗口可能遮挡它
+    std::vector<Rect> occluders;
+    grid_query_results_.clear();
+    window_grid_.Query(window_rect, grid_query_results_);
+    for (uint32_t other : grid_query_results_) {
+        if (other == index || !window_rect_owners_[other]->IsVisible() || !IsDrawnBefore(index, other)) {
+            continue;
         }
-        if (!merged) {
-            merged_areas.push_back(area);
+        Rect covered = window_rect.GetIntersection(window_rects_[other]);
+        // 停靠面板常常被单个窗口整个盖住，这时不需要做区域运算
+        if (covered.x == window_rect.x && covered.y == window_rect.y &&
+            covered.width == window_rect.width && covered.height == window_rect.height) {
+            return false;
         }
+        occluders.push_back(covered);
+    }
+    
+    exposed = Region(window_rect).Subtract(Region::FromRects(occluders));
+    return !exposed.IsEmpty();
+}
+
+// 绘制顺序（从后往前）按堆叠值，堆叠值越大越靠上
+bool WindowManager::IsDrawnBefore(size_t a, size_t b) const {
+    return window_z_[a] < window_z_[b];
+}
+
+void WindowManager::RaiseWindow(IWindow* window) {
+    int index = FindWindowRect(window);
+    if (index >= 0 && window_z_[index] != top_z_) {
+        window_z_[index] = ++top_z_;
+        layout_dirty_ = true;
+    }
+}
+
+void WindowManager::LowerWindow(IWindow* window) {
+    int index = FindWindowRect(window);
+    if (index >= 0 && window_z_[index] != bottom_z_) {
+        window_z_[index] = --bottom_z_;
+        layout_dirty_ = true;
     }
+}
+
+std::vector<IWindow*> WindowManager::GetZOrder() const {
+    std::vector<size_t> order(window_rects_.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [this](size_t a, size_t b) { return IsDrawnBefore(a, b); });
     
-    return merged_areas;
+    std::vector<IWindow*> windows;
+    windows.reserve(order.size());
+    for (size_t index : order) {
+        windows.push_back(window_rect_owners_[index]);
+    }
+    return windows;
 }
 
-// 渲染所有窗口，处理重叠边框
+void WindowManager::OnWindowActivated(IWindow* window) {
+    RaiseWindow(window);
+}
+
+// 渲染所有窗口：从前往后计算每个窗口的暴露区域和损坏区域，并行渲染需要重绘的窗口，再从后往前呈现
 void WindowManager::RenderAllWindows() {
-    // 获取所有窗口并按Z顺序排序（从后往前）
-    std::vector<IWindow*> visible_windows;
-    for (const auto& pair : windows_) {
-        if (pair.second->IsVisible()) {
-            visible_windows.push_back(pair.second.get());
+    if (!HasPendingRedraw()) {
+        // 没有任何变化，上一次的遮挡结果仍然有效，本帧什么都不画
+        render_stats_.rendered_windows = 0;
+        render_stats_.paced_windows = 0;
+        render_stats_.exposed_pixels = 0;
+        render_stats_.clean_windows = render_stats_.visible_windows - render_stats_.culled_windows;
+        frame_timings_.cull_ms = 0.0;
+        frame_timings_.render_phase_ms = 0.0;
+        frame_timings_.present_phase_ms = 0.0;
+        frame_timings_.windows.clear();
+        return;
+    }
+    layout_dirty_ = false;
+    
+    auto cull_start = std::chrono::steady_clock::now();
+    
+    // 获取所有可见窗口在矩形数组中的下标，并按Z顺序排序（从后往前）
+    std::vector<size_t> visible_windows;
+    visible_windows.reserve(window_rects_.size());
+    for (size_t i = 0; i < window_rects_.size(); ++i) {
+        window_visible_[i] = window_rect_owners_[i]->IsVisible() ? 1 : 0;
+        if (window_visible_[i]) {
+            visible_windows.push_back(i);
+        } else {
+            // 隐藏的窗口再次显示时，整个暴露区域都是新露出的
+            window_exposed_[i].Clear();
+            window_damage_[i].Clear();
         }
     }
     
-    // 按照Z顺序排序（这里简单按名称排序，实际应用中应使用窗口的Z顺序）
     std::sort(visible_windows.begin(), visible_windows.end(), 
-              [](IWindow* a, IWindow* b) {
-                  // 按照窗口位置排序，左上角坐标较小的在前面
-                  if (a->GetY() != b->GetY()) {
-                      return a->GetY() < b->GetY();
-                  }
-                  return a->GetX() < b->GetX();
-              });
-    
-    // 渲染每个窗口
-    for (IWindow* window : visible_windows) {
-        // 开始渲染
-        window->BeginRender();
+              [this](size_t a, size_t b) { return IsDrawnBefore(a, b); });
+    
+    render_stats_ = WindowRenderStats();
+    render_stats_.visible_windows = visible_windows.size();
+    
+    // 从最上层开始判断遮挡，完全被遮挡和没有损坏的窗口不参与渲染；
+    // 未到截止时间的窗口仍然作为遮挡物参与计算，只是本帧不渲染
+    std::vector<size_t> exposed_windows;
+    exposed_windows.reserve(visible_windows.size());
+    Region exposed;
+    for (auto it = visible_windows.rbegin(); it != visible_windows.rend(); ++it) {
+        size_t index = *it;
+        bool has_exposed = ComputeExposedRegion(index, exposed);
         
-        // 获取重叠区域
-        std::vector<Rect> overlapping_areas = GetOverlappingAreas(window);
+        // 转成客户区坐标后与上一次的暴露区域比较，新露出的部分需要重绘；
+        // 被遮挡部分的损坏不再保留，重新露出时会再次失效
+        exposed.Translate(-window_rects_[index].x, -window_rects_[index].y);
+        Region& damage = window_damage_[index];
+        damage.UnionWith(exposed.Subtract(window_exposed_[index]));
+        damage.IntersectWith(exposed);
+        window_exposed_[index] = exposed;
         
-        // 根据重叠情况调整渲染（这里只是概念性实现，实际的边框渲染取决于具体图形API）
-        if (!overlapping_areas.empty()) {
-            // 如果窗口与其他窗口重叠，则可能需要特殊处理边框
-            // 例如：不绘制重叠部分的边框
-            std::cout << "Window at (" << window->GetX() << ", " << window->GetY() 
-                      << ") has overlapping areas, adjusting border rendering..." << std::endl;
+        if (!has_exposed) {
+            render_stats_.culled_windows++;
+        } else if (damage.IsEmpty()) {
+            render_stats_.clean_windows++;
+        } else if (!IsFrameDue(index)) {
+            render_stats_.paced_windows++;
+        } else {
+            exposed_windows.push_back(index);
+            render_stats_.exposed_pixels += exposed.GetArea();
         }
-        
-        // 结束渲染
-        window->EndRender();
     }
-}
\ No newline at end of file
+    render_stats_.rendered_windows = exposed_windows.size();
+    
+    // 呈现顺序从后往前
+    std::reverse(exposed_windows.begin(), exposed_windows.end());
+    
+    auto render_start = std::chrono::steady_clock::now();
+    frame_timings_.cull_ms = std::chrono::duration<double, std::milli>(render_start - cull_start).count();
+    frame_timings_.windows.resize(exposed_windows.size());
+    
+    // 按窗口的固定线程分组；每个线程只写自己窗口的计时槽位
+    unsigned int thread_count = render_threads_.GetThreadCount();
+    thread_work_.resize(thread_count);
+    for (auto& work : thread_work_) {
+        work.clear();
+    }
+    for (size_t position = 0; position < exposed_windows.size(); ++position) {
+        thread_work_[window_slots_[exposed_windows[position]] % thread_count].push_back(position);
+    }
+    
+    render_threads_.RunOnEachThread([&](uint32_t thread_index) {
+        for (size_t position : thread_work_[thread_index]) {
+            IWindow* window = window_rect_owners_[exposed_windows[position]];
+            auto start = std::chrono::steady_clock::now();
+            window->BeginRender();
+            if (render_callback_) {
+                render_callback_(window, thread_index);
+            }
+            window->EndRender();
+            
+            WindowFrameTiming& timing = frame_timings_.windows[position];
+            timing.window = window;
+            timing.thread_index = thread_index;
+            timing.render_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            timing.present_ms = 0.0;
+        }
+    });
+    
+    auto present_start = std::chrono::steady_clock::now();
+    frame_timings_.render_phase_ms = std::chrono::duration<double, std::milli>(present_start - render_start).count();
+    
+    // 呈现阶段在调用线程上按堆叠顺序进行，上层窗口最后呈现
+    for (WindowFrameTiming& timing : frame_timings_.windows) {
+        auto start = std::chrono::steady_clock::now();
+        timing.window->Present();
+        timing.present_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    frame_timings_.present_phase_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::steady_clock::now() - present_start).count();
+    
+    for (size_t index : exposed_windows) {
+        window_damage_[index].Clear();
+    }
+}
+
+void WindowManager::Invalidate(IWindow* window) {
+    int index = FindWindowRect(window);
+    if (index >= 0) {
+        window_damage_[index] = Region(Rect(0, 0, window_rects_[index].width, window_rects_[index].height));
+    }
+}
+
+void WindowManager::Invalidate(IWindow* window, const Rect& rect) {
+    int index = FindWindowRect(window);
+    if (index >= 0) {
+        Rect client(0, 0, window_rects_[index].width, window_rects_[index].height);
+        window_damage_[index].UnionWith(Region(rect.GetIntersection(client)));
+    }
+}
+
+const Region& WindowManager::GetDamageRegion(IWindow* window) const {
+    static const Region empty;
+    int index = FindWindowRect(window);
+    return index >= 0 ? window_damage_[index] : empty;
+}
+
+bool WindowManager::HasPendingRedraw() const {
+    if (layout_dirty_) {
+        return true;
+    }
+    for (size_t i = 0; i < window_rect_owners_.size(); ++i) {
+        bool visible = window_rect_owners_[i]->IsVisible();
+        if (visible != (window_visible_[i] != 0) || (visible && !window_damage_[i].IsEmpty())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WindowManager::IsFrameDue(size_t index) const {
+    // 没有使用帧节奏时每次调用都渲染
+    if (!frame_pacer_.IsStarted()) {
+        return true;
+    }
+    uint32_t slot = window_slots_[index];
+    return frame_pacer_.HasRate(slot) ? frame_pacer_.IsDue(slot) : frame_pacer_.IsFrameDue();
+}
+
+void WindowManager::WaitForNextFrame() {
+    // 空闲帧什么都不画，晚醒一点没有影响
+    frame_pacer_.WaitForNextFrame(HasPendingRedraw());
+}
+
+void WindowManager::SetWindowFrameRate(IWindow* window, double hz) {
+    auto it = window_slot_index_.find(window);
+    if (it != window_slot_index_.end()) {
+        frame_pacer_.SetRate(it->second, hz);
+    }
+}
+
+void WindowManager::SetRenderCallback(WindowRenderCallback callback) {
+    render_callback_ = std::move(callback);
+}
+
+void WindowManager::SetMaxRenderThreads(unsigned int count) {
+    count = std::max(count, 1u);
+    if (count != render_threads_.GetThreadCount()) {
+        render_threads_.Resize(count);
+    }
+}
+
+unsigned int WindowManager::GetMaxRenderThreads() const {
+    return render_threads_.GetThreadCount();
+}
+
+unsigned int WindowManager::GetRenderThreadIndex(IWindow* window) const {
+    int index = FindWindowRect(window);
+    if (index < 0) {
+        return 0;
+    }
+    return window_slots_[index] % render_threads_.GetThreadCount();
+}
+
+void WindowManager::QueryWindows(const Rect& area, std::vector<IWindow*>& out) const {
+    grid_query_results_.clear();
+    window_grid_.Query(area, grid_query_results_);
+    for (uint32_t index : grid_query_results_) {
+        if (window_rect_owners_[index]->IsVisible()) {
+            out.push_back(window_rect_owners_[index]);
+        }
+    }
+}
@@ -1,42 +1,63 @@
 #pragma once
 #include "IWindow.h"
+#include "WindowFactory.h"
+#include "WindowHandle.h"
+#include "Rect.h"
+#include "Region.h"
+#include "SpatialGrid.h"
+#include "../Renderer/WorkerPool.h"
+#include "FramePacer.h"
+#include "WindowEventQueue.h"
+#include <functional>
 #include <vector>
 #include <memory>
 #include <unordered_map>
 #include <string>
 
-// 表示矩形区域的结构体
-struct Rect {
-    int x, y, width, height;
-    
-    Rect(int x = 0, int y = 0, int width = 0, int height = 0) 
-        : x(x), y(y), width(width), height(height) {}
-    
-    // 检查两个矩形是否相交
-    bool Intersects(const Rect& other) const {
-        return x < other.x + other.width &&
-               x + width > other.x &&
-               y < other.y + other.height &&
-               y + height > other.y;
-    }
-    
-    // 计算两个矩形的交集
-    Rect GetIntersection(const Rect& other) const {
-        int left = std::max(x, other.x);
-        int top = std::max(y, other.y);
-        int right = std::min(x + width, other.x + other.width);
-        int bottom = std::min(y + height, other.y + other.height);
-        
-        if (left < right && top < bottom) {
-            return Rect(left, top, right - left, bottom - top);
-        }
-        return Rect(0, 0, 0, 0); // 无交集
-    }
+// 最近一次RenderAllWindows的统计
+struct WindowRenderStats {
+    size_t visible_windows;   // 可见窗口数
+    size_t rendered_windows;  // 有暴露像素、实际渲染的窗口数
+    size_t culled_windows;    // 完全被遮挡而跳过的窗口数
+    size_t paced_windows;     // 有暴露像素但本帧未到帧节奏截止时间而跳过的窗口数
+    size_t clean_windows;     // 暴露部分没有损坏、不需要重绘而跳过的窗口数
+    int64_t exposed_pixels;   // 所有渲染窗口暴露区域的面积之和
+};
+
+// 渲染回调：在窗口的BeginRender和EndRender之间调用，thread_index为执行它的渲染线程。
+// 回调在渲染线程上并发执行，不能移动、缩放、创建或销毁窗口
+using WindowRenderCallback = std::function<void(IWindow* window, unsigned int thread_index)>;
+
+// 单个窗口在一帧中的耗时
+struct WindowFrameTiming {
+    IWindow* window;
+    unsigned int thread_index;
+    double render_ms;    // BeginRender、渲染回调和EndRender
+    double present_ms;   // Present
+};
+
+// 最近一次RenderAllWindows的耗时分解
+struct WindowFrameTimings {
+    double cull_ms;            // 遮挡计算
+    double render_phase_ms;    // 并行渲染阶段的墙钟时间
+    double present_phase_ms;   // 按堆叠顺序呈现的时间
+    std::vector<WindowFrameTiming> windows;  // 按呈现顺序（从下到上）
 };
 
-class WindowManager {
+// 事件从产生到被PollEvents取出的延迟统计（最近一段时间）
+struct WindowEventLatencyStats {
+    uint64_t events;    // 已取出的事件总数
+    uint64_t dropped;   // 队列满时丢弃的事件数
+    double average_ms;
+    double p50_ms;
+    double p99_ms;
+    double max_ms;
+};
+
+class WindowManager : private IWindowEventListener {
 public:
-    WindowManager();
+    // factory决定CreateWindow创建的窗口类型，默认使用当前平台的窗口
+    explicit WindowManager(WindowFactory factory = CreatePlatformWindow);
     ~WindowManager();
 
     // 创建窗口
@@ -46,9 +67,16 @@ public:
     // 销毁窗口
     bool DestroyWindow(const std::string& name);
     bool DestroyWindow(IWindow* window);
+    bool DestroyWindow(WindowHandle handle);
 
-    // 获取窗口
+    // 获取窗口；按句柄查找只做下标访问和代数比较，句柄过期时返回nullptr
     IWindow* GetWindow(const std::string& name) const;
+    IWindow* GetWindow(WindowHandle handle) const;
+
+    // 窗口的句柄，窗口不存在时返回无效句柄
+    WindowHandle GetWindowHandle(IWindow* window) const;
+    WindowHandle GetWindowHandle(const std::string& name) const;
+    bool IsValidHandle(WindowHandle handle) const;
 
     // 更新所有窗口
     void UpdateAllWindows();
@@ -68,20 +96,143 @@ public:
 
     // 主循环处理
     void ProcessMessages();
+    
+    // 事件队列：消息泵线程（调用ProcessMessages和UpdateAllWindows的线程）把归一化后的窗口和输入事件
+    // 写入单生产者单消费者环形队列，另一个线程（模拟或渲染线程）成批取出，消息泵不会被慢帧拖住。
+    // 队列满时新事件被丢弃并计数。PollEvents和GetEventLatencyStats只能在同一个消费者线程调用
+    size_t PollEvents(WindowEvent* out, size_t max_count);
+    WindowEventLatencyStats GetEventLatencyStats() const;
 
     // 退出应用
     void Exit();
 
     // 窗口重叠处理相关
-    void RenderAllWindows(); // 新增：渲染所有窗口，处理重叠边框
+    // 渲染暴露部分有损坏区域的可见窗口（完全被遮挡或没有损坏的窗口跳过BeginRender/EndRender）：
+    // 先在渲染线程上并行渲染，再在调用线程上按Z顺序从后往前Present。
+    // 布局、可见性和损坏区域都没有变化时直接返回，空闲时几乎不占CPU
+    void RenderAllWindows();
+    WindowRenderStats GetLastRenderStats() const { return render_stats_; }
+    const WindowFrameTimings& GetLastFrameTimings() const { return frame_timings_; }
+    
+    void SetRenderCallback(WindowRenderCallback callback);
+    
+    // 渲染线程数上限（至少为1，1表示在调用线程上依次渲染）。
+    // 每个窗口按槽位固定在一个线程上渲染，改变线程数会重新分配，应在创建渲染上下文之前设置
+    void SetMaxRenderThreads(unsigned int count);
+    unsigned int GetMaxRenderThreads() const;
+    // 窗口所在的渲染线程下标，窗口不存在时返回0
+    unsigned int GetRenderThreadIndex(IWindow* window) const;
+    
+    // 损坏区域（窗口客户区坐标）：新建、缩放和被遮挡部分重新露出时自动失效，
+    // 窗口内容变化时由调用方Invalidate。只能在消息泵线程调用，不能在渲染回调中调用
+    void Invalidate(IWindow* window);
+    void Invalidate(IWindow* window, const Rect& rect);
+    // 窗口本帧要重绘的区域（已去掉被遮挡的部分），供渲染回调只重绘这部分
+    const Region& GetDamageRegion(IWindow* window) const;
+    // 下一次RenderAllWindows是否有工作要做
+    bool HasPendingRedraw() const;
+    
+    // 帧节奏：主循环调用WaitForNextFrame代替sleep，没有待重绘的内容时不自旋。开始等待之后，
+    // 设置了单独帧率的窗口只在自己的截止时间到期的帧渲染，其余窗口跟随主节奏
+    FramePacer& GetFramePacer() { return frame_pacer_; }
+    void WaitForNextFrame();
+    // hz <= 0时窗口改为跟随主节奏
+    void SetWindowFrameRate(IWindow* window, double hz);
+    
+    // 堆叠顺序：新建和被激活的窗口在最上层。
+    // 这里只改变WindowManager的合成顺序，不会改变系统窗口的实际层次
+    void RaiseWindow(IWindow* window);
+    void LowerWindow(IWindow* window);
+    // 所有窗口从下到上的顺序
+    std::vector<IWindow*> GetZOrder() const;
+    
+    // 检查窗口是否与其他可见窗口重叠
+    bool IsWindowOverlapping(IWindow* window) const;
+    
+    // 获取窗口与其他可见窗口的重叠区域
+    std::vector<Rect> GetOverlappingAreas(IWindow* window) const;
+    Region GetOverlapRegion(IWindow* window) const;
+    
+    // 窗口中没有被上层可见窗口遮挡、需要重绘的精确区域
+    Region GetVisibleRegion(IWindow* window) const;
+    
+    // 把与area相交的可见窗口追加到out（顺序不定），代价与结果数成正比
+    void QueryWindows(const Rect& area, std::vector<IWindow*>& out) const;
 
 private:
-    std::unordered_map<std::string, std::unique_ptr<IWindow>> windows_;
+    // 窗口几何变化时更新紧凑矩形数组
+    void OnWindowGeometryChanged(IWindow* window, int x, int y, int width, int height) override;
+    // 窗口被激活时提到最上层
+    void OnWindowActivated(IWindow* window) override;
+    // 填写窗口句柄后写入事件队列
+    void OnWindowEvent(IWindow* window, const WindowEvent& event) override;
+
+    // 窗口槽位：销毁窗口时槽位放回空闲列表并把代数加一，使旧句柄失效
+    struct WindowSlot {
+        std::unique_ptr<IWindow> window;
+        std::string name;
+        uint32_t generation;
+        uint32_t dense_index;   // 在紧凑数组中的下标，槽位空闲时无意义
+    };
+
+    uint32_t AllocateSlot();
+    void DestroySlot(uint32_t slot);
+    // 句柄有效时返回槽位下标，否则返回-1
+    int FindSlot(WindowHandle handle) const;
+
+    // 维护紧凑矩形数组（删除时与末尾元素交换）
+    void AddWindowRect(uint32_t slot);
+    void RemoveWindowRect(uint32_t slot);
+    // 返回窗口在矩形数组中的下标，不存在时返回-1
+    int FindWindowRect(IWindow* window) const;
+    // 矩形数组下标a的窗口是否在b之前（之下）绘制
+    bool IsDrawnBefore(size_t a, size_t b) const;
+    // 计算下标为index的窗口未被上层窗口遮挡的区域，完全被遮挡时返回false
+    bool ComputeExposedRegion(size_t index, Region& exposed) const;
+    // 下标为index的窗口本帧是否到了帧节奏的截止时间
+    bool IsFrameDue(size_t index) const;
+
+    // 窗口按句柄存放在槽位数组中；名字索引只用于按名字查找，窗口指针索引用于窗口回调
+    std::vector<WindowSlot> slots_;
+    std::vector<uint32_t> free_slots_;
+    std::unordered_map<std::string, uint32_t> name_index_;
+    std::unordered_map<IWindow*, uint32_t> window_slot_index_;
+    
+    // 所有窗口的矩形连续存放，window_rect_owners_[i]是window_rects_[i]所属的窗口，window_slots_[i]是它的槽位。
+    // 只在移动/缩放事件或SetPosition/SetSize时更新，重叠和排序逻辑只读这个数组，不调用窗口的几何访问函数
+    std::vector<Rect> window_rects_;
+    std::vector<IWindow*> window_rect_owners_;
+    std::vector<uint32_t> window_slots_;
+    // 与window_rects_平行的堆叠值，越大越靠上
+    std::vector<int64_t> window_z_;
+    int64_t top_z_;
+    int64_t bottom_z_;
+    // 与window_rects_平行：待重绘的损坏区域和上一次渲染时的暴露区域（都是客户区坐标），以及上一次渲染时是否可见
+    std::vector<Region> window_damage_;
+    std::vector<Region> window_exposed_;
+    std::vector<uint8_t> window_visible_;
+    // 窗口创建、销毁、移动、缩放或改变堆叠顺序后置位，下一次渲染重新计算遮挡
+    bool layout_dirty_;
+    WindowRenderStats render_stats_;
+    WindowFactory window_factory_;
     bool running_;
     
-    // 检查窗口是否与其他窗口重叠
-    bool IsWindowOverlapping(IWindow* window) const;
+    // 以矩形数组下标为id的空间索引，与window_rects_同步更新
+    SpatialGrid window_grid_;
+    mutable std::vector<uint32_t> grid_query_results_;
     
-    // 获取窗口的重叠区域
-    std::vector<Rect> GetOverlappingAreas(IWindow* window) const;
+    // 并行渲染，每帧用RunOnEachThread让每个线程渲染分给自己的窗口
+    WorkerPool render_threads_;
+    WindowRenderCallback render_callback_;
+    WindowFrameTimings frame_timings_;
+    std::vector<std::vector<size_t>> thread_work_;   // 每个线程本帧要渲染的窗口（呈现顺序中的位置）
+    
+    // 主节奏和每个窗口的帧率（以槽位为id）
+    FramePacer frame_pacer_;
+    
+    // 消息泵线程到消费者线程的事件队列；以下延迟统计只由消费者线程读写
+    WindowEventQueue event_queue_;
+    std::vector<double> event_latencies_ms_;   // 最近事件延迟的环形缓冲
+    size_t event_latency_next_;
+    uint64_t events_polled_;
 };
\ No newline at end of file
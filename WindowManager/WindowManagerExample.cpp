@@ -1,8 +1,6 @@
 #include "WindowManager.h"
 #include "RenderWindow.h"
 #include <iostream>
-#include <thread>
-#include <chrono>
 
 int main() {
     std::cout << "Game Engine Window Manager Example" << std::endl;
@@ -63,10 +61,14 @@ int main() {
         // 简单的帧计数
         frame_count++;
         
-        // 添加一个小延迟以控制帧率
-        std::this_thread::sleep_for(std::chrono::milliseconds(16)); // 约60 FPS
+        // 按60 FPS的截止时间等待下一帧
+        window_manager.WaitForNextFrame();
     }
 
+    FramePacerStats pacing = window_manager.GetFramePacer().GetStats();
+    std::cout << "Frame time p50 " << pacing.p50_ms << " ms, p99 " << pacing.p99_ms
+              << " ms, missed deadlines " << pacing.missed_deadlines << std::endl;
+
     std::cout << "Exiting application..." << std::endl;
     window_manager.Exit();
 
@@ -0,0 +1,262 @@
+#include "WindowManager.h"
+#include "IWindow.h"
+#include "HeadlessWindow.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// 窗口重叠查询基准：使用无窗口后端创建10到10000个窗口，
+// 比较空间索引查询与逐对比较的耗时、移动窗口时更新索引的开销，以及带遮挡剔除的一次渲染
+namespace {
+    double ElapsedMs(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // 旧实现的做法：每个窗口都与所有其他窗口比较，返回有重叠的窗口数
+    size_t BruteForceOverlaps(const std::vector<IWindow*>& windows) {
+        size_t overlapped = 0;
+        for (IWindow* window : windows) {
+            Rect window_rect(window->GetX(), window->GetY(), window->GetWidth(), window->GetHeight());
+            bool overlapping = false;
+            for (IWindow* other : windows) {
+                if (other == window || !other->IsVisible()) {
+                    continue;
+                }
+                Rect other_rect(other->GetX(), other->GetY(), other->GetWidth(), other->GetHeight());
+                Rect intersection = window_rect.GetIntersection(other_rect);
+                if (intersection.width > 0 && intersection.height > 0) {
+                    overlapping = true;
+                }
+            }
+            overlapped += overlapping ? 1 : 0;
+        }
+        return overlapped;
+    }
+}
+
+int main() {
+    std::cout << "Window Overlap Benchmark (headless windows)" << std::endl;
+    std::cout << std::setw(8) << "windows"
+              << std::setw(14) << "indexed ms"
+              << std::setw(14) << "brute ms"
+              << std::setw(14) << "move ms"
+              << std::setw(12) << "overlapped"
+              << std::setw(14) << "render ms"
+              << std::setw(10) << "culled" << std::endl;
+
+    // 空间索引与逐对比较结果不一致时返回非零，CI据此发现索引回归
+    bool mismatch = false;
+    const int window_counts[] = { 10, 100, 1000, 10000 };
+    for (int count : window_counts) {
+        WindowManager wm(CreateHeadlessWindow);
+        std::mt19937 rng(12345);
+
+        // 桌面面积随窗口数增长，使每个窗口的平均重叠数大致不变
+        int desktop = static_cast<int>(600.0 * std::sqrt(static_cast<double>(count)));
+        std::uniform_int_distribution<int> position(0, desktop);
+        std::uniform_int_distribution<int> size(100, 400);
+
+        std::vector<IWindow*> windows;
+        windows.reserve(count);
+        for (int i = 0; i < count; ++i) {
+            IWindow* window = wm.CreateWindow("panel" + std::to_string(i), "Panel",
+                                              position(rng), position(rng), size(rng), size(rng));
+            if (window) {
+                window->Show();
+                windows.push_back(window);
+            }
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        size_t indexed_overlapped = 0;
+        for (IWindow* window : windows) {
+            indexed_overlapped += wm.GetOverlappingAreas(window).empty() ? 0 : 1;
+        }
+        double indexed_ms = ElapsedMs(start);
+
+        start = std::chrono::steady_clock::now();
+        size_t brute_overlapped = BruteForceOverlaps(windows);
+        double brute_ms = ElapsedMs(start);
+
+        // 每个窗口做一次小幅移动，空间索引随几何回调增量更新
+        std::uniform_int_distribution<int> jitter(-20, 20);
+        start = std::chrono::steady_clock::now();
+        for (IWindow* window : windows) {
+            window->SetPosition(window->GetX() + jitter(rng), window->GetY() + jitter(rng));
+        }
+        double move_ms = ElapsedMs(start);
+
+        // 一次完整的遮挡计算和渲染，完全被遮挡的窗口会被跳过
+        start = std::chrono::steady_clock::now();
+        wm.RenderAllWindows();
+        double render_ms = ElapsedMs(start);
+        WindowRenderStats stats = wm.GetLastRenderStats();
+
+        std::cout << std::setw(8) << windows.size()
+                  << std::setw(14) << std::fixed << std::setprecision(3) << indexed_ms
+                  << std::setw(14) << brute_ms
+                  << std::setw(14) << move_ms
+                  << std::setw(12) << indexed_overlapped
+                  << std::setw(14) << render_ms
+                  << std::setw(10) << stats.culled_windows
+                  << (indexed_overlapped == brute_overlapped ? "" : "  MISMATCH") << std::endl;
+        mismatch = mismatch || indexed_overlapped != brute_overlapped;
+    }
+
+    // 并行渲染：每个窗口的渲染回调做固定量的CPU工作，比较不同渲染线程数下的渲染阶段耗时
+    std::cout << std::endl << "Parallel render (1000 windows, busy-work callback)" << std::endl;
+    std::cout << std::setw(8) << "threads"
+              << std::setw(14) << "render ms"
+              << std::setw(14) << "present ms"
+              << std::setw(14) << "slowest ms" << std::endl;
+
+    unsigned int max_threads = std::max(4u, std::thread::hardware_concurrency());
+    for (unsigned int threads = 1; threads <= max_threads; threads *= 2) {
+        WindowManager wm(CreateHeadlessWindow);
+        wm.SetMaxRenderThreads(threads);
+        wm.SetRenderCallback([](IWindow* window, unsigned int) {
+            volatile double sink = 0.0;
+            for (int i = 0; i < 20000; ++i) {
+                sink = sink + std::sqrt(static_cast<double>(i + window->GetX()));
+            }
+        });
+
+        // 窗口互不重叠，全部参与渲染
+        for (int i = 0; i < 1000; ++i) {
+            IWindow* window = wm.CreateWindow("panel" + std::to_string(i), "Panel",
+                                              (i % 40) * 110, (i / 40) * 110, 100, 100);
+            if (window) {
+                window->Show();
+            }
+        }
+
+        wm.RenderAllWindows();
+        const WindowFrameTimings& timings = wm.GetLastFrameTimings();
+        double slowest_ms = 0.0;
+        for (const WindowFrameTiming& timing : timings.windows) {
+            slowest_ms = std::max(slowest_ms, timing.render_ms);
+        }
+
+        std::cout << std::setw(8) << threads
+                  << std::setw(14) << std::fixed << std::setprecision(3) << timings.render_phase_ms
+                  << std::setw(14) << timings.present_phase_ms
+                  << std::setw(14) << slowest_ms << std::endl;
+    }
+
+    // 事件队列：输入线程向无窗口后端注入鼠标移动事件，主线程作为消息泵转入WindowManager的事件队列，
+    // 模拟线程每帧（约4ms）成批取出一次，慢帧不会拖住消息泵
+    std::cout << std::endl << "Event queue (input thread -> pump -> simulation thread)" << std::endl;
+    {
+        WindowManager wm(CreateHeadlessWindow);
+        HeadlessWindow* window = static_cast<HeadlessWindow*>(wm.CreateWindow("input", "Input", 0, 0, 800, 600));
+        const int event_count = 100000;
+        std::atomic<bool> simulation_done(false);
+
+        std::thread input([&] {
+            for (int i = 0; i < event_count; ++i) {
+                WindowEvent event = {};
+                event.type = WindowEventType::MouseMove;
+                event.x = i % 800;
+                event.y = i % 600;
+                while (!window->PushEvent(event)) {
+                    std::this_thread::yield();
+                }
+                if (i % 64 == 0) {
+                    std::this_thread::sleep_for(std::chrono::microseconds(100));
+                }
+            }
+        });
+
+        std::thread simulation([&] {
+            std::vector<WindowEvent> batch(1024);
+            uint64_t received = 0;
+            while (received + wm.GetEventLatencyStats().dropped < static_cast<uint64_t>(event_count)) {
+                size_t count;
+                while ((count = wm.PollEvents(batch.data(), batch.size())) > 0) {
+                    received += count;
+                }
+                std::this_thread::sleep_for(std::chrono::milliseconds(4));
+            }
+            WindowEventLatencyStats stats = wm.GetEventLatencyStats();
+            std::cout << std::setw(10) << "events" << std::setw(10) << "dropped"
+                      << std::setw(14) << "avg ms" << std::setw(14) << "p50 ms"
+                      << std::setw(14) << "p99 ms" << std::setw(14) << "max ms" << std::endl;
+            std::cout << std::setw(10) << received << std::setw(10) << stats.dropped
+                      << std::setw(14) << std::fixed << std::setprecision(3) << stats.average_ms
+                      << std::setw(14) << stats.p50_ms << std::setw(14) << stats.p99_ms
+                      << std::setw(14) << stats.max_ms << std::endl;
+            simulation_done = true;
+        });
+
+        // 消息泵
+        while (!simulation_done) {
+            wm.ProcessMessages();
+            wm.UpdateAllWindows();
+            std::this_thread::yield();
+        }
+        input.join();
+        simulation.join();
+    }
+
+    // 空闲编辑器：10个面板按60 FPS运行1秒，比较只重绘损坏窗口与每帧全部失效时的CPU占用
+    std::cout << std::endl << "Idle editor (10 panels, 60 Hz, 1 s)" << std::endl;
+    std::cout << std::setw(16) << "mode"
+              << std::setw(10) << "frames"
+              << std::setw(12) << "rendered"
+              << std::setw(10) << "cpu %" << std::endl;
+
+    for (int invalidate_all = 0; invalidate_all <= 1; ++invalidate_all) {
+        WindowManager wm(CreateHeadlessWindow);
+        wm.SetRenderCallback([](IWindow* window, unsigned int) {
+            volatile double sink = 0.0;
+            for (int i = 0; i < 200000; ++i) {
+                sink = sink + std::sqrt(static_cast<double>(i + window->GetX()));
+            }
+        });
+
+        std::vector<IWindow*> panels;
+        for (int i = 0; i < 10; ++i) {
+            panels.push_back(wm.CreateWindow("panel" + std::to_string(i), "Panel",
+                                             (i % 5) * 320, (i / 5) * 480, 300, 460));
+        }
+        wm.ShowAllWindows();
+        wm.GetFramePacer().SetTargetRate(60.0);
+        // 第一帧总要画出所有面板，不计入统计
+        wm.RenderAllWindows();
+
+        size_t rendered = 0;
+        std::clock_t cpu_start = std::clock();
+        auto wall_start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < 60; ++frame) {
+            wm.WaitForNextFrame();
+            wm.UpdateAllWindows();
+            if (invalidate_all) {
+                for (IWindow* panel : panels) {
+                    wm.Invalidate(panel);
+                }
+            }
+            wm.RenderAllWindows();
+            rendered += wm.GetLastRenderStats().rendered_windows;
+        }
+        double cpu_ms = 1000.0 * (std::clock() - cpu_start) / CLOCKS_PER_SEC;
+        double wall_ms = ElapsedMs(wall_start);
+
+        std::cout << std::setw(16) << (invalidate_all ? "invalidate all" : "damage only")
+                  << std::setw(10) << 60
+                  << std::setw(12) << rendered
+                  << std::setw(10) << std::fixed << std::setprecision(1) << 100.0 * cpu_ms / wall_ms << std::endl;
+    }
+
+    if (mismatch) {
+        std::cout << std::endl << "FAILED: indexed overlap query disagrees with brute force" << std::endl;
+    }
+    return mismatch ? 1 : 0;
+}
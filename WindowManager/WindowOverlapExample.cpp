@@ -1,8 +1,6 @@
 #include "WindowManager.h"
 #include "IWindow.h"
 #include <iostream>
-#include <thread>
-#include <chrono>
 
 int main() {
     std::cout << "Window Overlap Border Rendering Example" << std::endl;
@@ -31,17 +29,40 @@ int main() {
     // 显示所有窗口
     wm.ShowAllWindows();
     
+    // 主循环20帧每秒，窗口3单独以10帧每秒渲染
+    wm.GetFramePacer().SetTargetRate(20.0);
+    wm.SetWindowFrameRate(window3, 10.0);
+    
     // 主循环
     int frame_count = 0;
     const int max_frames = 100; // 运行一定帧数后退出
     
     while (frame_count < max_frames && wm.GetWindowCount() > 0) {
+        // 等到下一帧的截止时间
+        wm.WaitForNextFrame();
         wm.ProcessMessages();
         
-        // 每隔一定时间渲染一次
-        if (frame_count % 10 == 0) {
+        // 三个窗口的内容都在播放动画，每帧整窗标记为需要重绘
+        wm.Invalidate(window1);
+        wm.Invalidate(window2);
+        wm.Invalidate(window3);
+        
+        // 按Z顺序渲染有损坏区域的窗口，跳过完全被遮挡的窗口；
+        // 窗口3只在自己10帧每秒的截止时间到期时渲染，其余帧计入paced，损坏区域留到下次渲染
+        wm.RenderAllWindows();
+        if (frame_count % 15 == 0) {
             std::cout << "\n--- Rendering Frame " << frame_count << " ---" << std::endl;
-            wm.RenderAllWindows(); // 使用新的渲染方法，处理重叠边框
+            WindowRenderStats stats = wm.GetLastRenderStats();
+            std::cout << "Rendered " << stats.rendered_windows << "/" << stats.visible_windows
+                      << " windows, culled " << stats.culled_windows
+                      << ", paced " << stats.paced_windows
+                      << ", exposed pixels " << stats.exposed_pixels << std::endl;
+        }
+        
+        // 轮流把窗口提到最上层，相当于用户依次激活它们
+        if (frame_count % 20 == 0) {
+            IWindow* windows[] = { window1, window2, window3 };
+            wm.RaiseWindow(windows[(frame_count / 20) % 3]);
         }
         
         // 模拟动画 - 移动窗口
@@ -57,10 +78,13 @@ int main() {
             window3->SetPosition(x - 2, y - 3);
         }
         
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
         frame_count++;
     }
     
+    FramePacerStats pacing = wm.GetFramePacer().GetStats();
+    std::cout << "\nFrame time: avg " << pacing.average_ms << " ms, p50 " << pacing.p50_ms
+              << " ms, p95 " << pacing.p95_ms << " ms, p99 " << pacing.p99_ms
+              << " ms, max " << pacing.max_ms << " ms, missed " << pacing.missed_deadlines << std::endl;
     std::cout << "Example completed." << std::endl;
     
     return 0;